@@ -0,0 +1,103 @@
+// Benchmarks.cpp : Allocator benchmark suite, replays engine shaped allocation traces on every allocator and prints the results as JSON.
+// Usage: Benchmarks.exe [output.json], results go to the standard output when no file is given.
+//
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Suite\AlignmentChecks.h"
+#include "Suite\AllocatorAdapters.h"
+#include "Suite\BenchmarkReport.h"
+#include "Suite\ConcurrencyChecks.h"
+#include "Suite\Traces.h"
+
+namespace
+{
+    using namespace SDBX::Benchmark;
+
+    static const size_t COMPONENT_SIZE{ 64 };
+    static const size_t LONG_LIVED_COUNT{ 10000 };
+
+    void Record(std::vector<BenchmarkResult>& results, BenchmarkResult&& result)
+    {
+        std::cerr << result.trace << "\t" << result.allocator << "\t" << result.nsPerOp << " ns/op\n";
+        results.push_back(std::move(result));
+    }
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+    //results of allocators handing out misaligned memory are meaningless
+    if (!RunAlignmentChecks())
+        return 1;
+
+    //nor are the ones of a pool handing a slot to two threads
+    if (!RunConcurrencyChecks())
+        return 1;
+
+    std::vector<BenchmarkResult> results{};
+
+    Record(results, RunFrameScratch<MallocAdapter>());
+    Record(results, RunFrameScratch<NewAdapter>());
+    Record(results, RunFrameScratch<StackAdapter>());
+    Record(results, RunFrameScratch<SinglyLinkedAdapter>());
+    Record(results, RunFrameScratch<DoublyLinkedAdapter>());
+    Record(results, RunFrameScratch<BuddyAdapter>());
+    Record(results, RunFrameScratch<TlsfAdapter>());
+
+    Record(results, RunComponentChurn<MallocAdapter>());
+    Record(results, RunComponentChurn<NewAdapter>());
+    Record(results, RunComponentChurn<SinglyLinkedAdapter>());
+    Record(results, RunComponentChurn<DoublyLinkedAdapter>());
+    Record(results, RunComponentChurn<BuddyAdapter>());
+    Record(results, RunComponentChurn<TlsfAdapter>());
+    Record(results, RunComponentChurn<FixedSizeAdapter<COMPONENT_SIZE>>());
+    Record(results, RunComponentChurn<PagedFixedSizeAdapter<COMPONENT_SIZE>>());
+
+    Record(results, RunLongLivedMixed<MallocAdapter>(LONG_LIVED_COUNT));
+    Record(results, RunLongLivedMixed<NewAdapter>(LONG_LIVED_COUNT));
+    Record(results, RunLongLivedMixed<DoublyLinkedAdapter>(LONG_LIVED_COUNT));
+    Record(results, RunLongLivedMixed<BuddyAdapter>(LONG_LIVED_COUNT));
+    Record(results, RunLongLivedMixed<TlsfAdapter>(LONG_LIVED_COUNT));
+
+    //size class bins against the linear free list walk as the live population grows
+    for (size_t liveCount : { size_t(1000), size_t(10000), size_t(100000) })
+    {
+        Record(results, RunLongLivedMixed<SinglyLinkedAdapter>(liveCount));
+        Record(results, RunLongLivedMixed<LinearSinglyLinkedAdapter>(liveCount));
+    }
+
+    const uint32_t threadCount{ std::clamp(std::thread::hardware_concurrency(), 2u, 8u) };
+    Record(results, RunMultithreadedBursts<MallocAdapter>(threadCount));
+    Record(results, RunMultithreadedBursts<NewAdapter>(threadCount));
+    Record(results, RunMultithreadedBursts<StackAdapter>(threadCount));
+    Record(results, RunMultithreadedBursts<SinglyLinkedAdapter>(threadCount));
+    Record(results, RunMultithreadedBursts<DoublyLinkedAdapter>(threadCount));
+    Record(results, RunMultithreadedBursts<BuddyAdapter>(threadCount));
+    Record(results, RunMultithreadedBursts<TlsfAdapter>(threadCount));
+
+    //scaling of the thread safe allocators, from one thread to the machine width
+    const uint32_t maxThreadCount{ std::max(std::thread::hardware_concurrency(), 1u) };
+    for (uint32_t sharedThreadCount{ 1 }; sharedThreadCount <= maxThreadCount; sharedThreadCount *= 2)
+    {
+        Record(results, RunSharedPoolChurn<MallocAdapter>(sharedThreadCount, COMPONENT_SIZE));
+        Record(results, RunSharedPoolChurn<NewAdapter>(sharedThreadCount, COMPONENT_SIZE));
+        Record(results, RunSharedPoolChurn<ConcurrentPoolAdapter<COMPONENT_SIZE>>(sharedThreadCount, COMPONENT_SIZE));
+    }
+
+    if (argc > 1)
+    {
+        std::ofstream file{ std::filesystem::path{ argv[1] } };
+        WriteJson(file, results);
+    }
+    else
+    {
+        WriteJson(std::cout, results);
+    }
+
+    return 0;
+}
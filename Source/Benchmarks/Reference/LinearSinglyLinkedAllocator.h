@@ -0,0 +1,161 @@
+#pragma once
+#include "Core/Log/Logger.h"
+
+//Linear walk version of SDBX::Memory::SinglyLinkedAllocator (single address ordered free list), kept as the baseline for the segregated fit benchmark
+
+namespace SDBX
+{
+	namespace Benchmark
+	{
+		static const size_t DEFAULT_LINEAR_BLOCKSIZE = 16;
+
+		template<size_t BLOCKSIZE = DEFAULT_LINEAR_BLOCKSIZE>
+		class LinearSinglyLinkedAllocator final
+		{
+		public:
+
+			struct Block
+			{
+				size_t blockCount;
+				union {
+					Block* pNext;
+					char data[BLOCKSIZE - sizeof(blockCount)];
+				};
+			};
+
+			explicit LinearSinglyLinkedAllocator(size_t nbBlocks);
+			LinearSinglyLinkedAllocator(const LinearSinglyLinkedAllocator& other) = delete;
+			LinearSinglyLinkedAllocator(LinearSinglyLinkedAllocator&& other) noexcept = delete;
+			LinearSinglyLinkedAllocator& operator=(const LinearSinglyLinkedAllocator& other) = delete;
+			LinearSinglyLinkedAllocator& operator=(LinearSinglyLinkedAllocator&& other) noexcept = delete;
+			~LinearSinglyLinkedAllocator();
+
+			template<typename Typename, typename... Arg_Type>
+			Typename* Acquire(Arg_Type&&... args);
+
+			template<typename Typename>
+			void Release(Typename* pData);
+
+			// Raw memory, the data is aligned on sizeof(size_t)
+			void* Acquire(size_t nbBytes);
+			void Release(void* pData);
+
+		private:
+			Block* m_pHead;
+			size_t m_BufferSize;
+		};
+	}
+}
+
+template<size_t BLOCKSIZE>
+SDBX::Benchmark::LinearSinglyLinkedAllocator<BLOCKSIZE>::LinearSinglyLinkedAllocator(size_t nbBlocks)
+	: m_pHead(nullptr)
+	, m_BufferSize()
+{
+	//adjust memory block to allocate if it doesn't respect memory alignment
+	m_BufferSize = nbBlocks;
+
+	//allocate one extra block for the head
+	m_pHead = new Block[nbBlocks + 1];
+
+	if (m_pHead)
+	{
+		m_pHead->blockCount = 0;
+		Block* pNext{ m_pHead + 1 };
+		pNext->blockCount = nbBlocks;
+		pNext->pNext = nullptr;
+		m_pHead->pNext = pNext;
+	}
+}
+
+template<size_t BLOCKSIZE>
+SDBX::Benchmark::LinearSinglyLinkedAllocator<BLOCKSIZE>::~LinearSinglyLinkedAllocator()
+{
+	delete[] m_pHead;
+	m_pHead = nullptr;
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename, typename... Arg_Type>
+Typename* SDBX::Benchmark::LinearSinglyLinkedAllocator<BLOCKSIZE>::Acquire(Arg_Type&&... args)
+{
+	//call Typename constructor, buffer overrun warning can be ignored because, if it happens, we already "reserved" the blocks that will be overwritten
+	return new (Acquire(sizeof(Typename))) Typename(std::forward<Arg_Type>(args)...);
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename>
+void SDBX::Benchmark::LinearSinglyLinkedAllocator<BLOCKSIZE>::Release(Typename* pData)
+{
+	pData->~Typename();
+	Release(static_cast<void*>(pData));
+}
+
+template<size_t BLOCKSIZE>
+void* SDBX::Benchmark::LinearSinglyLinkedAllocator<BLOCKSIZE>::Acquire(size_t nbBytes)
+{
+	SDBX_ASSERT_MSG(m_pHead, "m_pHead is NULL")
+
+	//calculate the number of blocks required to store the data (requires extra space to store the block count) 
+	const auto nbBlocks = (nbBytes + sizeof(Block::blockCount) + BLOCKSIZE - 1) / BLOCKSIZE;
+
+	Block* pPreviousBlock = m_pHead;
+	Block* pNextBlock = m_pHead->pNext;
+	while (pNextBlock != nullptr && pNextBlock->blockCount < nbBlocks) {
+		pPreviousBlock = pNextBlock;
+		pNextBlock = pNextBlock->pNext;
+	}
+
+	//Reached end of the buffer without finding enough space
+	SDBX_ASSERT_MSG(pNextBlock, "Allocator out of memory")
+
+	//if the free block is larger than the requested number of blocks, need to split the free block to only acquire the minimum requested number of block and create a free block with the rest
+	if (pNextBlock->blockCount > nbBlocks)
+	{
+		Block* newBlock = pNextBlock + nbBlocks;
+		newBlock->blockCount = pNextBlock->blockCount - nbBlocks;
+		newBlock->pNext = pNextBlock->pNext;
+		pNextBlock->blockCount = nbBlocks;
+		pNextBlock->pNext = newBlock;
+	}
+
+	pPreviousBlock->pNext = pNextBlock->pNext;
+
+	return pNextBlock->data;
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Benchmark::LinearSinglyLinkedAllocator<BLOCKSIZE>::Release(void* pData)
+{
+	SDBX_ASSERT_MSG(m_pHead, "m_pHead is NULL")
+
+	Block* pBlock = reinterpret_cast<Block*>(static_cast<char*>(pData) - sizeof(Block::blockCount));
+
+	SDBX_ASSERT(pBlock > m_pHead && pBlock < m_pHead + m_BufferSize + 1)
+
+	Block* pFreeBlock{ m_pHead };
+	while (pFreeBlock->pNext != nullptr && pFreeBlock->pNext < pBlock)
+	{
+		pFreeBlock = pFreeBlock->pNext;
+	}
+
+	pBlock->pNext = pFreeBlock->pNext;
+	pFreeBlock->pNext = pBlock;
+
+	Block* pBlockNeighbor{ pBlock + pBlock->blockCount };
+	if (pBlock->pNext == pBlockNeighbor) //check if the right adjacent block are free, merge it with the current node if it is
+	{
+		pBlock->blockCount += pBlockNeighbor->blockCount;
+		pBlock->pNext = pBlockNeighbor->pNext;
+	}
+
+	if (pFreeBlock == m_pHead)
+		return;
+
+	Block* pFreeBlockNeighbor{ pFreeBlock + pFreeBlock->blockCount };
+	if (pBlock == pFreeBlockNeighbor)  //check if the current block being released is the right neighbor of the previous free block, merge them if it is
+	{
+		pFreeBlock->blockCount += pBlock->blockCount;
+		pFreeBlock->pNext = pBlock->pNext;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "AlignmentChecks.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <new>
+
+#include "Core/Memory/Allocator/BuddyAllocator.h"
+#include "Core/Memory/Allocator/ConcurrentPoolAllocator.h"
+#include "Core/Memory/Allocator/DoubleEndedStackAllocator.h"
+#include "Core/Memory/Allocator/DoublyLinkedAllocator.h"
+#include "Core/Memory/Allocator/FixedSizeAllocator.h"
+#include "Core/Memory/Allocator/FrameAllocator.h"
+#include "Core/Memory/Allocator/HandlePool.h"
+#include "Core/Memory/Allocator/MemoryResource.h"
+#include "Core/Memory/Allocator/PagedFixedSizeAllocator.h"
+#include "Core/Memory/Allocator/ScopedStackAllocator.h"
+#include "Core/Memory/Allocator/SinglyLinkedAllocator.h"
+#include "Core/Memory/Allocator/SmallObjectAllocator.h"
+#include "Core/Memory/Allocator/StackAllocator.h"
+#include "Core/Memory/Allocator/TlsfAllocator.h"
+
+namespace
+{
+    using namespace SDBX::Memory;
+
+    template<size_t ALIGNMENT>
+    struct alignas(ALIGNMENT) Aligned
+    {
+        char bytes[ALIGNMENT];
+    };
+
+    static const size_t ARENA_SIZE{ 1024 * 1024 };
+    static const size_t ARRAY_COUNT{ 7 };
+    static const size_t POOL_COUNT{ 64 };
+
+    struct Checker
+    {
+        bool isPassing{ true };
+
+        template<typename Typename>
+        void Check(const char* pAllocatorName, const char* pKind, const Typename* pData)
+        {
+            if (pData != nullptr && IsAligned(pData, alignof(Typename)))
+                return;
+
+            std::cerr << "Alignment check failed: " << pAllocatorName << " " << pKind << " of alignas(" << alignof(Typename) << ") at " << static_cast<const void*>(pData) << "\n";
+            isPassing = false;
+        }
+
+        void Fail(const char* pAllocatorName, const char* pMessage)
+        {
+            std::cerr << "Check failed: " << pAllocatorName << " " << pMessage << "\n";
+            isPassing = false;
+        }
+    };
+
+    //allocators releasing single objects and arrays one by one
+    template<typename Typename, typename Allocator>
+    void CheckGeneral(Checker& checker, const char* pAllocatorName, Allocator& allocator)
+    {
+        //one of each first so the arrays don't start on a fresh arena
+        Typename* pSingle{ allocator.template Acquire<Typename>() };
+        Typename* pArray{ allocator.template AcquireArray<Typename>(ARRAY_COUNT) };
+        Typename* pSecondSingle{ allocator.template Acquire<Typename>() };
+        checker.Check(pAllocatorName, "single", pSingle);
+        checker.Check(pAllocatorName, "array", pArray);
+        checker.Check(pAllocatorName, "single", pSecondSingle);
+
+        allocator.Release(pSingle);
+        allocator.ReleaseArray(pArray, ARRAY_COUNT);
+        allocator.Release(pSecondSingle);
+    }
+
+    //stack like allocators, everything goes at once
+    template<typename Typename, typename Allocator>
+    void CheckStack(Checker& checker, const char* pAllocatorName, Allocator& allocator)
+    {
+        //a byte first so the top of the stack is misaligned
+        allocator.Acquire(1, 1);
+        checker.Check(pAllocatorName, "single", allocator.template Acquire<Typename>());
+        checker.Check(pAllocatorName, "array", allocator.template AcquireArray<Typename>(ARRAY_COUNT));
+        allocator.Reset();
+    }
+
+#if !defined(SDBX_LOGGER_RELEASE_ASSERT) && !defined(_DEBUG) && !defined(DEBUG)
+    //std::pmr containers write through whatever allocate returns, an exhausted allocator must throw.
+    //Only without asserts, the out of memory assert breaks into the debugger first
+    template<typename Allocator>
+    void CheckExhaustion(Checker& checker, const char* pAllocatorName, Allocator& allocator)
+    {
+        MemoryResource<Allocator> resource{ allocator };
+        try
+        {
+            [[maybe_unused]] void* pData{ resource.allocate(ARENA_SIZE * 2, 16) };
+            checker.Fail(pAllocatorName, "handed out more memory than it has");
+        }
+        catch (const std::bad_alloc&)
+        {
+        }
+    }
+
+    void CheckExhaustion(Checker& checker)
+    {
+        {
+            StackAllocator allocator{ ARENA_SIZE };
+            CheckExhaustion(checker, "StackResource", allocator);
+        }
+        {
+            SinglyLinkedAllocator<> allocator{ ARENA_SIZE / DEFAULT_BLOCKSIZE };
+            CheckExhaustion(checker, "SinglyLinkedResource", allocator);
+        }
+        {
+            DoublyLinkedAllocator<> allocator{ ARENA_SIZE / DEFAULT_DL_BLOCKSIZE };
+            CheckExhaustion(checker, "DoublyLinkedResource", allocator);
+        }
+        {
+            TlsfAllocator allocator{ ARENA_SIZE };
+            CheckExhaustion(checker, "MemoryResource<TlsfAllocator>", allocator);
+        }
+    }
+#endif
+
+    template<typename Typename>
+    void CheckAlignment(Checker& checker)
+    {
+        {
+            StackAllocator allocator{ ARENA_SIZE };
+            CheckStack<Typename>(checker, "StackAllocator", allocator);
+        }
+        {
+            ScopedStackAllocator allocator{ ARENA_SIZE };
+            CheckStack<Typename>(checker, "ScopedStackAllocator", allocator);
+        }
+        {
+            DoubleEndedStackAllocator allocator{ ARENA_SIZE };
+            for (DoubleEndedStackAllocator::End end : { DoubleEndedStackAllocator::End::Bottom, DoubleEndedStackAllocator::End::Top })
+            {
+                allocator.Acquire(end, 1, 1);
+                checker.Check("DoubleEndedStackAllocator", "single", allocator.Acquire<Typename>(end));
+                checker.Check("DoubleEndedStackAllocator", "array", allocator.AcquireArray<Typename>(end, ARRAY_COUNT));
+            }
+            allocator.Reset();
+        }
+        {
+            FrameAllocator& allocator{ FrameAllocator::GetInstance() };
+            allocator.Acquire(1, 1);
+            checker.Check("FrameAllocator", "single", allocator.Acquire<Typename>());
+            checker.Check("FrameAllocator", "array", allocator.AcquireArray<Typename>(ARRAY_COUNT));
+        }
+        {
+            SinglyLinkedAllocator<> allocator{ ARENA_SIZE / DEFAULT_BLOCKSIZE };
+            CheckGeneral<Typename>(checker, "SinglyLinkedAllocator", allocator);
+        }
+        {
+            DoublyLinkedAllocator<> allocator{ ARENA_SIZE / DEFAULT_DL_BLOCKSIZE };
+            CheckGeneral<Typename>(checker, "DoublyLinkedAllocator", allocator);
+        }
+        {
+            BuddyAllocator<> allocator{ ARENA_SIZE };
+            CheckGeneral<Typename>(checker, "BuddyAllocator", allocator);
+        }
+        {
+            TlsfAllocator allocator{ ARENA_SIZE };
+            CheckGeneral<Typename>(checker, "TlsfAllocator", allocator);
+        }
+        {
+            SmallObjectAllocator allocator{};
+            CheckGeneral<Typename>(checker, "SmallObjectAllocator", allocator);
+        }
+        {
+            TlsfAllocator allocator{ ARENA_SIZE };
+            MemoryResource<TlsfAllocator> resource{ allocator };
+            void* pData{ resource.allocate(sizeof(Typename) * ARRAY_COUNT, alignof(Typename)) };
+            checker.Check("MemoryResource<TlsfAllocator>", "array", static_cast<Typename*>(pData));
+            resource.deallocate(pData, sizeof(Typename) * ARRAY_COUNT, alignof(Typename));
+        }
+
+        //pools of Typename only hand out single objects
+        {
+            FixedSizeAllocator<Typename> allocator{ POOL_COUNT };
+            Typename* pFirst{ allocator.Acquire() };
+            Typename* pSecond{ allocator.Acquire() };
+            checker.Check("FixedSizeAllocator", "single", pFirst);
+            checker.Check("FixedSizeAllocator", "single", pSecond);
+            allocator.Release(pFirst);
+            allocator.Release(allocator.begin());
+        }
+        {
+            PagedFixedSizeAllocator<Typename> allocator{ POOL_COUNT };
+            Typename* pFirst{ allocator.Acquire() };
+            Typename* pSecond{ allocator.Acquire() };
+            checker.Check("PagedFixedSizeAllocator", "single", pFirst);
+            checker.Check("PagedFixedSizeAllocator", "single", pSecond);
+            allocator.Release(pFirst);
+            allocator.Release(pSecond);
+        }
+        {
+            HandlePool<Typename> pool{ uint32_t(POOL_COUNT) };
+            const Handle first{ pool.Acquire() };
+            const Handle second{ pool.Acquire() };
+            checker.Check("HandlePool", "single", pool.Get(first));
+            checker.Check("HandlePool", "single", pool.Get(second));
+            pool.Release(first);
+            pool.Release(second);
+        }
+        {
+            ConcurrentPoolAllocator<Typename> allocator{ POOL_COUNT };
+            Typename* pFirst{ allocator.Acquire() };
+            Typename* pSecond{ allocator.Acquire() };
+            checker.Check("ConcurrentPoolAllocator", "single", pFirst);
+            checker.Check("ConcurrentPoolAllocator", "single", pSecond);
+            allocator.Release(pFirst);
+            allocator.Release(pSecond);
+        }
+    }
+}
+
+bool SDBX::Benchmark::RunAlignmentChecks()
+{
+    Checker checker{};
+    CheckAlignment<Aligned<16>>(checker);
+    CheckAlignment<Aligned<32>>(checker);
+    CheckAlignment<Aligned<64>>(checker);
+#if !defined(SDBX_LOGGER_RELEASE_ASSERT) && !defined(_DEBUG) && !defined(DEBUG)
+    CheckExhaustion(checker);
+#endif
+    return checker.isPassing;
+}
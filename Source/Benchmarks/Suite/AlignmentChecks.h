@@ -0,0 +1,13 @@
+#pragma once
+
+//Checked section run before the benchmarks: every allocator hands out single objects and arrays of alignas 16, 32 and 64 types
+//on their alignment. Checks don't rely on the engine asserts so they also run in release, where every MemoryResource is also checked to throw
+//std::bad_alloc once its allocator is exhausted.
+namespace SDBX
+{
+    namespace Benchmark
+    {
+        // Prints every failure to the error output, returns false when any check failed
+        bool RunAlignmentChecks();
+    }
+}
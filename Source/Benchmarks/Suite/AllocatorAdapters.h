@@ -0,0 +1,219 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "Core/Memory/Allocator/BuddyAllocator.h"
+#include "Core/Memory/Allocator/ConcurrentPoolAllocator.h"
+#include "Core/Memory/Allocator/DoublyLinkedAllocator.h"
+#include "Core/Memory/Allocator/FixedSizeAllocator.h"
+#include "Core/Memory/Allocator/PagedFixedSizeAllocator.h"
+#include "Core/Memory/Allocator/SinglyLinkedAllocator.h"
+#include "Core/Memory/Allocator/StackAllocator.h"
+#include "Core/Memory/Allocator/TlsfAllocator.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Benchmarks/Reference/LinearSinglyLinkedAllocator.h"
+
+//Common face of every allocator for the traces:
+//  HAS_RELEASE       allocations can be released one by one, otherwise the trace calls Reset
+//  MOVES_ON_RELEASE  Release moves the last allocation into the freed one (FixedSizeAllocator)
+//  IS_FIXED_SIZE     only serves allocations up to FIXED_SIZE bytes
+//Capacity is the arena size in bytes, ignored by malloc/new.
+namespace SDBX
+{
+    namespace Benchmark
+    {
+        template<size_t SIZE>
+        struct Payload
+        {
+            alignas(std::max_align_t) char bytes[SIZE];
+        };
+
+        struct MallocAdapter final
+        {
+            static constexpr const char* NAME{ "malloc" };
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ false };
+
+            explicit MallocAdapter(size_t) {}
+
+            void* Acquire(size_t nbBytes, size_t) { return malloc(nbBytes); }
+            void Release(void* pData) { free(pData); }
+            void Reset() {}
+            double GetFragmentation() const { return -1.0; }
+        };
+
+        struct NewAdapter final
+        {
+            static constexpr const char* NAME{ "new" };
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ false };
+
+            explicit NewAdapter(size_t) {}
+
+            void* Acquire(size_t nbBytes, size_t) { return ::operator new(nbBytes); }
+            void Release(void* pData) { ::operator delete(pData); }
+            void Reset() {}
+            double GetFragmentation() const { return -1.0; }
+        };
+
+        struct StackAdapter final
+        {
+            static constexpr const char* NAME{ "StackAllocator" };
+            static const bool HAS_RELEASE{ false };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ false };
+
+            explicit StackAdapter(size_t capacity) : allocator{ capacity } {}
+
+            void* Acquire(size_t nbBytes, size_t alignment) { return allocator.Acquire(nbBytes, alignment); }
+            void Release(void*) {}
+            void Reset() { allocator.Reset(); }
+            double GetFragmentation() const { return 0.0; }
+
+            Memory::StackAllocator allocator;
+        };
+
+        template<typename Allocator, size_t BLOCKSIZE>
+        struct BlockAdapter
+        {
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ false };
+
+            explicit BlockAdapter(size_t capacity) : allocator{ capacity / BLOCKSIZE } {}
+
+            void* Acquire(size_t nbBytes, size_t alignment) { return allocator.Acquire(nbBytes, alignment); }
+            void Release(void* pData) { allocator.Release(pData); }
+            void Reset() {}
+            double GetFragmentation() const { return Memory::ComputeFragmentation(allocator.GetLargestFreeBlock(), allocator.GetFreeSpaceAmount()); }
+
+            Allocator allocator;
+        };
+
+        struct SinglyLinkedAdapter final : BlockAdapter<Memory::SinglyLinkedAllocator<>, Memory::DEFAULT_BLOCKSIZE>
+        {
+            static constexpr const char* NAME{ "SinglyLinkedAllocator" };
+            using BlockAdapter::BlockAdapter;
+        };
+
+        struct DoublyLinkedAdapter final : BlockAdapter<Memory::DoublyLinkedAllocator<>, Memory::DEFAULT_DL_BLOCKSIZE>
+        {
+            static constexpr const char* NAME{ "DoublyLinkedAllocator" };
+            using BlockAdapter::BlockAdapter;
+        };
+
+        struct TlsfAdapter final
+        {
+            static constexpr const char* NAME{ "TlsfAllocator" };
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ false };
+
+            explicit TlsfAdapter(size_t capacity) : allocator{ capacity } {}
+
+            void* Acquire(size_t nbBytes, size_t alignment) { return allocator.Acquire(nbBytes, alignment); }
+            void Release(void* pData) { allocator.Release(pData); }
+            void Reset() {}
+            double GetFragmentation() const { return Memory::ComputeFragmentation(allocator.GetLargestFreeBlock(), allocator.GetFreeSpaceAmount()); }
+
+            Memory::TlsfAllocator allocator;
+        };
+
+        // Capacity is rounded up to a power of two
+        struct BuddyAdapter final
+        {
+            static constexpr const char* NAME{ "BuddyAllocator" };
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ false };
+
+            explicit BuddyAdapter(size_t capacity) : allocator{ size_t(1) << (SDBX::Bit::FindLastSet(capacity - 1) + 1) } {}
+
+            void* Acquire(size_t nbBytes, size_t alignment) { return allocator.Acquire(nbBytes, alignment); }
+            void Release(void* pData) { allocator.Release(pData); }
+            void Reset() {}
+            double GetFragmentation() const { return Memory::ComputeFragmentation(allocator.GetLargestFreeBlock(), allocator.GetFreeSpaceAmount()); }
+
+            Memory::BuddyAllocator<64> allocator;
+        };
+
+        // Address ordered linear walk, data is only aligned on sizeof(size_t)
+        struct LinearSinglyLinkedAdapter final
+        {
+            static constexpr const char* NAME{ "LinearSinglyLinkedAllocator" };
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ false };
+
+            explicit LinearSinglyLinkedAdapter(size_t capacity) : allocator{ capacity / DEFAULT_LINEAR_BLOCKSIZE } {}
+
+            void* Acquire(size_t nbBytes, size_t) { return allocator.Acquire(nbBytes); }
+            void Release(void* pData) { allocator.Release(pData); }
+            void Reset() {}
+            double GetFragmentation() const { return -1.0; }
+
+            LinearSinglyLinkedAllocator<> allocator;
+        };
+
+        template<size_t SIZE>
+        struct FixedSizeAdapter final
+        {
+            static constexpr const char* NAME{ "FixedSizeAllocator" };
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ true };
+            static const bool IS_FIXED_SIZE{ true };
+            static const size_t FIXED_SIZE{ SIZE };
+
+            explicit FixedSizeAdapter(size_t capacity) : allocator{ capacity / sizeof(Payload<SIZE>) } {}
+
+            void* Acquire(size_t, size_t) { return allocator.Acquire(); }
+            void Release(void* pData) { allocator.Release(static_cast<Payload<SIZE>*>(pData)); }
+            void Reset() {}
+            double GetFragmentation() const { return 0.0; }
+
+            Memory::FixedSizeAllocator<Payload<SIZE>> allocator;
+        };
+
+        template<size_t SIZE>
+        struct PagedFixedSizeAdapter final
+        {
+            static constexpr const char* NAME{ "PagedFixedSizeAllocator" };
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ true };
+            static const size_t FIXED_SIZE{ SIZE };
+
+            explicit PagedFixedSizeAdapter(size_t capacity) : allocator{ capacity / sizeof(Payload<SIZE>) } {}
+
+            void* Acquire(size_t, size_t) { return allocator.Acquire(); }
+            void Release(void* pData) { allocator.Release(static_cast<Payload<SIZE>*>(pData)); }
+            void Reset() {}
+            double GetFragmentation() const { return 0.0; }
+
+            Memory::PagedFixedSizeAllocator<Payload<SIZE>> allocator;
+        };
+
+        // Thread safe, the only pool the shared_pool_churn trace can be run with besides malloc/new
+        template<size_t SIZE>
+        struct ConcurrentPoolAdapter final
+        {
+            static constexpr const char* NAME{ "ConcurrentPoolAllocator" };
+            static const bool HAS_RELEASE{ true };
+            static const bool MOVES_ON_RELEASE{ false };
+            static const bool IS_FIXED_SIZE{ true };
+            static const size_t FIXED_SIZE{ SIZE };
+
+            explicit ConcurrentPoolAdapter(size_t capacity) : allocator{ capacity / sizeof(Payload<SIZE>) } {}
+
+            void* Acquire(size_t, size_t) { return allocator.Acquire(); }
+            void Release(void* pData) { allocator.Release(static_cast<Payload<SIZE>*>(pData)); }
+            void Reset() {}
+            double GetFragmentation() const { return 0.0; }
+
+            Memory::ConcurrentPoolAllocator<Payload<SIZE>> allocator;
+        };
+    }
+}
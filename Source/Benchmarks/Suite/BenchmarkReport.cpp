@@ -0,0 +1,131 @@
+#include "BenchmarkReport.h"
+
+#include <algorithm>
+#include <numeric>
+
+#if defined(_WIN32)
+    #include <Windows.h>
+    #include <Psapi.h>
+#else
+    #include <fstream>
+    #include <unistd.h>
+#endif
+
+double SDBX::Benchmark::GetClockOverhead()
+{
+    static const double overhead{ []()
+    {
+        //smallest observed now() pair, anything above that is scheduling noise
+        double minNs{ 1e9 };
+        for (int idx{}; idx < 10000; ++idx)
+        {
+            const auto start{ BenchClock::now() };
+            const auto end{ BenchClock::now() };
+            minNs = std::min(minNs, std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        return minNs;
+    }() };
+
+    return overhead;
+}
+
+size_t SDBX::Benchmark::GetCurrentRss()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? size_t(counters.WorkingSetSize) : 0;
+#else
+    //second field of statm is the resident page count
+    std::ifstream statm{ "/proc/self/statm" };
+    size_t totalPages{}, residentPages{};
+    statm >> totalPages >> residentPages;
+    return residentPages * size_t(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+SDBX::Benchmark::LatencyRecorder::LatencyRecorder(size_t expectedOpCount)
+    : m_Samples()
+    , m_ClockOverhead(GetClockOverhead())
+{
+    m_Samples.reserve(expectedOpCount);
+}
+
+void SDBX::Benchmark::LatencyRecorder::Add(double latencyNs)
+{
+    m_Samples.push_back(float(std::max(0.0, latencyNs - m_ClockOverhead)));
+}
+
+void SDBX::Benchmark::LatencyRecorder::Merge(const LatencyRecorder& other)
+{
+    m_Samples.insert(std::end(m_Samples), std::begin(other.m_Samples), std::end(other.m_Samples));
+}
+
+double SDBX::Benchmark::LatencyRecorder::GetMean() const
+{
+    return m_Samples.empty() ? 0.0 : std::accumulate(std::begin(m_Samples), std::end(m_Samples), 0.0) / double(m_Samples.size());
+}
+
+double SDBX::Benchmark::LatencyRecorder::GetPercentile(double percentile)
+{
+    if (m_Samples.empty())
+        return 0.0;
+
+    const size_t rank{ std::min(m_Samples.size() - 1, size_t(percentile * double(m_Samples.size()))) };
+    std::nth_element(std::begin(m_Samples), std::begin(m_Samples) + rank, std::end(m_Samples));
+    return m_Samples[rank];
+}
+
+void SDBX::Benchmark::RssSampler::Sample()
+{
+    const size_t rss{ GetCurrentRss() };
+    size_t peak{ m_Peak.load(std::memory_order_relaxed) };
+    while (peak < rss && !m_Peak.compare_exchange_weak(peak, rss, std::memory_order_relaxed))
+    {
+    }
+}
+
+SDBX::Benchmark::BenchmarkResult SDBX::Benchmark::MakeResult(const char* trace, const char* allocator, uint32_t threadCount, LatencyRecorder& latencies, double totalTimeMs, const RssSampler& rss, double fragmentation)
+{
+    BenchmarkResult result{};
+    result.trace = trace;
+    result.allocator = allocator;
+    result.threadCount = threadCount;
+    result.opCount = latencies.GetCount();
+    result.totalTimeMs = totalTimeMs;
+    result.nsPerOp = latencies.GetMean();
+    result.p50Ns = latencies.GetPercentile(0.5);
+    result.p99Ns = latencies.GetPercentile(0.99);
+    result.maxNs = latencies.GetPercentile(1.0);
+    result.peakRssBytes = rss.GetPeak();
+    result.rssGrowthBytes = rss.GetGrowth();
+    result.fragmentation = fragmentation;
+    return result;
+}
+
+void SDBX::Benchmark::WriteJson(std::ostream& stream, const std::vector<BenchmarkResult>& results)
+{
+    stream << "{\n  \"clockOverheadNs\": " << GetClockOverhead() << ",\n  \"results\": [\n";
+    for (size_t idx{}; idx < results.size(); ++idx)
+    {
+        const BenchmarkResult& result{ results[idx] };
+        stream << "    { \"trace\": \"" << result.trace << "\", \"allocator\": \"" << result.allocator << "\""
+            << ", \"threads\": " << result.threadCount
+            << ", \"ops\": " << result.opCount
+            << ", \"totalMs\": " << result.totalTimeMs
+            << ", \"nsPerOp\": " << result.nsPerOp
+            << ", \"p50Ns\": " << result.p50Ns
+            << ", \"p99Ns\": " << result.p99Ns
+            << ", \"maxNs\": " << result.maxNs
+            << ", \"peakRssBytes\": " << result.peakRssBytes
+            << ", \"rssGrowthBytes\": " << result.rssGrowthBytes
+            << ", \"fragmentation\": ";
+
+        if (result.fragmentation >= 0.0)
+            stream << result.fragmentation;
+        else
+            stream << "null";
+
+        stream << " }" << (idx + 1 < results.size() ? "," : "") << "\n";
+    }
+    stream << "  ]\n}\n";
+}
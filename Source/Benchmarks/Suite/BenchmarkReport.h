@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace SDBX
+{
+    namespace Benchmark
+    {
+        using BenchClock = std::chrono::steady_clock;
+
+        // Cost of a now() pair, subtracted from every recorded latency
+        double GetClockOverhead();
+
+        // Resident set size of the process in bytes
+        size_t GetCurrentRss();
+
+        // Latency of every timed operation of a run, in ns
+        class LatencyRecorder final
+        {
+        public:
+            explicit LatencyRecorder(size_t expectedOpCount = 0);
+
+            template<typename Operation>
+            void Measure(Operation&& operation)
+            {
+                const auto start{ BenchClock::now() };
+                operation();
+                const auto end{ BenchClock::now() };
+                Add(std::chrono::duration<double, std::nano>(end - start).count());
+            }
+
+            void Add(double latencyNs);
+            void Merge(const LatencyRecorder& other);
+
+            size_t GetCount() const { return m_Samples.size(); }
+            double GetMean() const;
+            // Sorts the samples, percentile in [0, 1]
+            double GetPercentile(double percentile);
+
+        private:
+            std::vector<float> m_Samples;
+            double m_ClockOverhead;
+        };
+
+        // Highest RSS seen at the sample points of a run, can be sampled from several threads.
+        // RSS is process wide, pages kept by the heap after a previous run hide part of the growth of the next one
+        class RssSampler final
+        {
+        public:
+            RssSampler() : m_Baseline{ GetCurrentRss() }, m_Peak{ m_Baseline } {}
+
+            void Sample();
+
+            size_t GetPeak() const { return m_Peak.load(std::memory_order_relaxed); }
+            size_t GetGrowth() const { return GetPeak() > m_Baseline ? GetPeak() - m_Baseline : 0; }
+
+        private:
+            size_t m_Baseline;
+            std::atomic<size_t> m_Peak;
+        };
+
+        struct BenchmarkResult
+        {
+            std::string trace;
+            std::string allocator;
+            uint32_t threadCount;
+            size_t opCount;
+            double totalTimeMs;
+            double nsPerOp;
+            double p50Ns;
+            double p99Ns;
+            double maxNs;
+            size_t peakRssBytes;
+            size_t rssGrowthBytes;
+            // Negative when the allocator can't report it (malloc/new)
+            double fragmentation;
+        };
+
+        BenchmarkResult MakeResult(const char* trace, const char* allocator, uint32_t threadCount, LatencyRecorder& latencies, double totalTimeMs, const RssSampler& rss, double fragmentation);
+
+        void WriteJson(std::ostream& stream, const std::vector<BenchmarkResult>& results);
+    }
+}
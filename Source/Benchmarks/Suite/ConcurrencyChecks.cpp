@@ -0,0 +1,187 @@
+#include "ConcurrencyChecks.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Core/Memory/Allocator/ConcurrentPoolAllocator.h"
+
+namespace
+{
+    using namespace SDBX::Memory;
+
+    //past the magazine count so the last threads go through the shared stack
+    static const uint32_t THREAD_COUNT{ MAX_POOL_THREAD_CACHES + 8 };
+    static const size_t ROUND_COUNT{ 200 };
+    //above the magazine size so magazines are refilled and flushed every round
+    static const size_t BATCH_COUNT{ 100 };
+    static const size_t MAX_INBOX_COUNT{ BATCH_COUNT * 2 };
+    static const size_t MAGAZINE_SIZE{ 64 };
+
+    //objects in hand, in a full inbox and in a batch being handed over for every thread, plus the slots parked in magazines
+    static const size_t POOL_COUNT{ THREAD_COUNT * (BATCH_COUNT * 2 + MAX_INBOX_COUNT) + MAX_POOL_THREAD_CACHES * MAGAZINE_SIZE };
+
+    struct Element
+    {
+        uint32_t owner;
+    };
+
+    //objects handed over by the previous thread of the ring
+    struct Inbox
+    {
+        std::mutex mutex;
+        std::vector<Element*> elements;
+    };
+
+    struct SharedState
+    {
+        ConcurrentPoolAllocator<Element, MAGAZINE_SIZE> pool{ POOL_COUNT };
+        //slots are handed out front to back the first time, the first acquire gives the start of the buffer
+        Element* pFirstSlot{ nullptr };
+        std::vector<std::atomic<bool>> isSlotUsed = std::vector<std::atomic<bool>>(POOL_COUNT);
+        std::vector<Inbox> inboxes = std::vector<Inbox>(THREAD_COUNT);
+        std::atomic<uint32_t> startedCount{ 0 };
+        std::atomic<uint32_t> doneCount{ 0 };
+        std::atomic<uint32_t> uncachedCount{ 0 };
+        std::atomic<size_t> doubleAcquireCount{ 0 };
+        std::atomic<size_t> corruptionCount{ 0 };
+        std::atomic<size_t> outOfMemoryCount{ 0 };
+    };
+
+    Element* Acquire(SharedState& state, uint32_t threadIdx)
+    {
+        Element* pElement{ state.pool.Acquire() };
+        if (pElement == nullptr)
+        {
+            state.outOfMemoryCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        const size_t slotIdx{ size_t(pElement - state.pFirstSlot) };
+        if (slotIdx >= POOL_COUNT)
+        {
+            state.corruptionCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        //the holder of the slot keeps it, releasing it twice would break the pool before the failure is reported
+        if (state.isSlotUsed[slotIdx].exchange(true, std::memory_order_acquire))
+        {
+            state.doubleAcquireCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        pElement->owner = threadIdx;
+        return pElement;
+    }
+
+    //everything in the inbox was acquired by the previous thread of the ring
+    void ReleaseInbox(SharedState& state, uint32_t threadIdx)
+    {
+        std::vector<Element*> elements{};
+        {
+            Inbox& inbox{ state.inboxes[threadIdx] };
+            std::lock_guard<std::mutex> lock{ inbox.mutex };
+            elements.swap(inbox.elements);
+        }
+
+        const uint32_t previousThreadIdx{ (threadIdx + THREAD_COUNT - 1) % THREAD_COUNT };
+        for (Element* pElement : elements)
+        {
+            if (pElement->owner != previousThreadIdx)
+                state.corruptionCount.fetch_add(1, std::memory_order_relaxed);
+
+            //cleared first, the slot can be handed out again as soon as it is released
+            state.isSlotUsed[size_t(pElement - state.pFirstSlot)].store(false, std::memory_order_release);
+            state.pool.Release(pElement);
+        }
+    }
+
+    bool TryHandOver(SharedState& state, uint32_t threadIdx, std::vector<Element*>& elements)
+    {
+        Inbox& inbox{ state.inboxes[(threadIdx + 1) % THREAD_COUNT] };
+        std::lock_guard<std::mutex> lock{ inbox.mutex };
+        if (inbox.elements.size() >= MAX_INBOX_COUNT)
+            return false;
+
+        inbox.elements.insert(std::end(inbox.elements), std::begin(elements), std::end(elements));
+        elements.clear();
+        return true;
+    }
+
+    void RunThread(SharedState& state, uint32_t threadIdx)
+    {
+        //every thread is alive before any of them takes a magazine, the last ones to ask don't get one
+        state.startedCount.fetch_add(1, std::memory_order_relaxed);
+        while (state.startedCount.load(std::memory_order_relaxed) < THREAD_COUNT)
+            std::this_thread::yield();
+
+        if (GetPoolThreadIndex() == NO_POOL_THREAD_CACHE)
+            state.uncachedCount.fetch_add(1, std::memory_order_relaxed);
+
+        std::vector<Element*> elements{};
+        for (size_t round{}; round < ROUND_COUNT; ++round)
+        {
+            for (size_t idx{}; idx < BATCH_COUNT; ++idx)
+            {
+                Element* pElement{ Acquire(state, threadIdx) };
+                if (pElement != nullptr)
+                    elements.push_back(pElement);
+            }
+
+            //the next thread may be behind, keep emptying our own inbox while waiting for room in its one
+            while (!TryHandOver(state, threadIdx, elements))
+            {
+                ReleaseInbox(state, threadIdx);
+                std::this_thread::yield();
+            }
+
+            ReleaseInbox(state, threadIdx);
+        }
+
+        //the previous thread can still be handing objects over, our magazine stays taken until every thread is done
+        state.doneCount.fetch_add(1, std::memory_order_acq_rel);
+        while (state.doneCount.load(std::memory_order_acquire) < THREAD_COUNT)
+        {
+            ReleaseInbox(state, threadIdx);
+            std::this_thread::yield();
+        }
+
+        ReleaseInbox(state, threadIdx);
+    }
+}
+
+bool SDBX::Benchmark::RunConcurrencyChecks()
+{
+    SharedState state{};
+    state.pFirstSlot = state.pool.Acquire();
+    state.pool.Release(state.pFirstSlot);
+
+    std::vector<std::thread> threads{};
+    for (uint32_t threadIdx{}; threadIdx < THREAD_COUNT; ++threadIdx)
+        threads.emplace_back([&state, threadIdx]() { RunThread(state, threadIdx); });
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    bool isPassing{ true };
+    auto check{ [&isPassing](bool isOk, const char* pMessage)
+    {
+        if (isOk)
+            return;
+
+        std::cerr << "Concurrency check failed: ConcurrentPoolAllocator " << pMessage << "\n";
+        isPassing = false;
+    } };
+
+    check(state.doubleAcquireCount.load() == 0, "handed out a slot that was still in use");
+    check(state.corruptionCount.load() == 0, "handed out a slot outside its buffer or overwrote a live object");
+    check(state.outOfMemoryCount.load() == 0, "ran out of slots");
+    check(state.uncachedCount.load() > 0, "gave a magazine to every thread, the shared stack wasn't checked");
+    check(state.doubleAcquireCount.load() > 0 || state.pool.Size() == 0, "still counts live objects once every thread released its objects");
+    return isPassing;
+}
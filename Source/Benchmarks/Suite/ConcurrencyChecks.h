@@ -0,0 +1,13 @@
+#pragma once
+
+//Checked section run before the benchmarks: threads hand ConcurrentPoolAllocator objects to each other and release them there,
+//with more threads alive than the pool has magazines so the shared fallback is exercised too. Every acquire checks that its slot
+//isn't held by anyone else. Checks don't rely on the engine asserts so they also run in release.
+namespace SDBX
+{
+    namespace Benchmark
+    {
+        // Prints every failure to the error output, returns false when any check failed
+        bool RunConcurrencyChecks();
+    }
+}
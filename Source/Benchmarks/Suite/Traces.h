@@ -0,0 +1,317 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks/Suite/BenchmarkReport.h"
+
+//Synthetic allocation traces shaped after the engine workloads, every trace is seeded so all allocators replay the same sequence.
+//Adapters are described in AllocatorAdapters.h.
+namespace SDBX
+{
+    namespace Benchmark
+    {
+        // Log-uniform size in [minBytes, maxBytes], small sizes are as likely per octave as large ones
+        inline size_t RandomSize(std::mt19937& rng, size_t minBytes, size_t maxBytes)
+        {
+            std::uniform_real_distribution<double> exponent{ std::log2(double(minBytes)), std::log2(double(maxBytes)) };
+            return std::clamp(size_t(std::exp2(exponent(rng))), minBytes, maxBytes);
+        }
+
+        inline double ElapsedMs(BenchClock::time_point start) { return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count(); }
+
+        // Per frame scratch: many small short lived allocations, all freed (or reset) at the end of the frame in reverse order
+        template<typename Adapter>
+        BenchmarkResult RunFrameScratch()
+        {
+            static const size_t FRAME_COUNT{ 300 };
+            static const size_t ALLOCATIONS_PER_FRAME{ 2000 };
+            static const size_t MIN_SIZE{ 16 };
+            static const size_t MAX_SIZE{ 1024 };
+
+            std::mt19937 rng{ 42 };
+            RssSampler rss{};
+            LatencyRecorder latencies{ FRAME_COUNT * ALLOCATIONS_PER_FRAME * 2 };
+            double fragmentation{};
+
+            Adapter adapter{ ALLOCATIONS_PER_FRAME * MAX_SIZE * 2 };
+            std::vector<void*> frame{};
+            frame.reserve(ALLOCATIONS_PER_FRAME);
+
+            const auto start{ BenchClock::now() };
+            for (size_t frameIdx{}; frameIdx < FRAME_COUNT; ++frameIdx)
+            {
+                for (size_t idx{}; idx < ALLOCATIONS_PER_FRAME; ++idx)
+                {
+                    const size_t nbBytes{ RandomSize(rng, MIN_SIZE, MAX_SIZE) };
+                    void* pData{};
+                    latencies.Measure([&]() { pData = adapter.Acquire(nbBytes, 16); });
+                    frame.push_back(pData);
+                }
+
+                rss.Sample();
+                if (frameIdx + 1 == FRAME_COUNT)
+                    fragmentation = adapter.GetFragmentation();
+
+                if constexpr (Adapter::HAS_RELEASE)
+                {
+                    for (auto it{ frame.rbegin() }; it != frame.rend(); ++it)
+                        latencies.Measure([&]() { adapter.Release(*it); });
+                }
+                else
+                {
+                    latencies.Measure([&]() { adapter.Reset(); });
+                }
+                frame.clear();
+            }
+
+            return MakeResult("frame_scratch", Adapter::NAME, 1, latencies, ElapsedMs(start), rss, fragmentation);
+        }
+
+        // Component churn: a stable population of same size objects, random ones destroyed and recreated
+        template<typename Adapter>
+        BenchmarkResult RunComponentChurn()
+        {
+            static const size_t COMPONENT_SIZE{ 64 };
+            static const size_t LIVE_COUNT{ 10000 };
+            static const size_t CHURN_COUNT{ 100000 };
+
+            std::mt19937 rng{ 42 };
+            RssSampler rss{};
+            LatencyRecorder latencies{ LIVE_COUNT + CHURN_COUNT * 2 };
+
+            Adapter adapter{ LIVE_COUNT * COMPONENT_SIZE * 4 };
+            std::vector<void*> live{};
+            live.reserve(LIVE_COUNT);
+
+            const auto start{ BenchClock::now() };
+            for (size_t idx{}; idx < LIVE_COUNT; ++idx)
+            {
+                void* pData{};
+                latencies.Measure([&]() { pData = adapter.Acquire(COMPONENT_SIZE, 8); });
+                live.push_back(pData);
+            }
+
+            for (size_t op{}; op < CHURN_COUNT; ++op)
+            {
+                const size_t victim{ rng() % live.size() };
+                latencies.Measure([&]() { adapter.Release(live[victim]); });
+
+                //the pool moved its last object into the released slot, the last address is the one that is free now
+                if constexpr (!Adapter::MOVES_ON_RELEASE)
+                    live[victim] = live.back();
+                live.pop_back();
+
+                void* pData{};
+                latencies.Measure([&]() { pData = adapter.Acquire(COMPONENT_SIZE, 8); });
+                live.push_back(pData);
+
+                if (op % 1024 == 0)
+                    rss.Sample();
+            }
+            const double totalTimeMs{ ElapsedMs(start) };
+            const double fragmentation{ adapter.GetFragmentation() };
+
+            for (auto it{ live.rbegin() }; it != live.rend(); ++it)
+                adapter.Release(*it);
+
+            return MakeResult("component_churn", Adapter::NAME, 1, latencies, totalTimeMs, rss, fragmentation);
+        }
+
+        // Long lived resources: a population of liveCount mixed sizes (64B to 16KB) with a slow turnover, the fragmentation stress case.
+        // Reported as long_lived_mixed_<liveCount>
+        template<typename Adapter>
+        BenchmarkResult RunLongLivedMixed(size_t liveCount)
+        {
+            static const size_t REPLACE_COUNT{ 50000 };
+            static const size_t MIN_SIZE{ 64 };
+            static const size_t MAX_SIZE{ 16 * 1024 };
+
+            std::mt19937 rng{ 42 };
+            RssSampler rss{};
+            LatencyRecorder latencies{ liveCount + REPLACE_COUNT * 2 };
+
+            //mean log-uniform size is ~3KB, three times the expected live size leaves room for fragmentation
+            Adapter adapter{ liveCount * 3 * 3 * 1024 };
+            std::vector<void*> live{};
+            live.reserve(liveCount);
+
+            const auto start{ BenchClock::now() };
+            for (size_t idx{}; idx < liveCount; ++idx)
+            {
+                const size_t nbBytes{ RandomSize(rng, MIN_SIZE, MAX_SIZE) };
+                void* pData{};
+                latencies.Measure([&]() { pData = adapter.Acquire(nbBytes, 8); });
+                live.push_back(pData);
+            }
+
+            for (size_t op{}; op < REPLACE_COUNT; ++op)
+            {
+                const size_t victim{ rng() % live.size() };
+                latencies.Measure([&]() { adapter.Release(live[victim]); });
+
+                const size_t nbBytes{ RandomSize(rng, MIN_SIZE, MAX_SIZE) };
+                latencies.Measure([&]() { live[victim] = adapter.Acquire(nbBytes, 8); });
+
+                if (op % 1024 == 0)
+                    rss.Sample();
+            }
+            const double totalTimeMs{ ElapsedMs(start) };
+            const double fragmentation{ adapter.GetFragmentation() };
+
+            for (void* pData : live)
+                adapter.Release(pData);
+
+            const std::string trace{ "long_lived_mixed_" + std::to_string(liveCount) };
+            return MakeResult(trace.c_str(), Adapter::NAME, 1, latencies, totalTimeMs, rss, fragmentation);
+        }
+
+        // Multithreaded bursts: every thread allocates a burst of small objects then frees them in random order.
+        // Engine allocators are single threaded so each thread owns one, malloc/new share the process heap.
+        template<typename Adapter>
+        BenchmarkResult RunMultithreadedBursts(uint32_t threadCount)
+        {
+            static const size_t BURST_COUNT{ 200 };
+            static const size_t BURST_SIZE{ 1000 };
+            static const size_t MIN_SIZE{ 16 };
+            static const size_t MAX_SIZE{ 256 };
+
+            RssSampler rss{};
+            std::vector<LatencyRecorder> threadLatencies(threadCount, LatencyRecorder{ BURST_COUNT * BURST_SIZE * 2 });
+            std::vector<double> threadFragmentation(threadCount, 0.0);
+            std::vector<std::thread> threads{};
+
+            const auto start{ BenchClock::now() };
+            for (uint32_t threadIdx{}; threadIdx < threadCount; ++threadIdx)
+            {
+                threads.emplace_back([&, threadIdx]()
+                {
+                    std::mt19937 rng{ 42 + threadIdx };
+                    LatencyRecorder& latencies{ threadLatencies[threadIdx] };
+                    Adapter adapter{ BURST_SIZE * MAX_SIZE * 4 };
+                    std::vector<void*> burst{};
+                    burst.reserve(BURST_SIZE);
+
+                    for (size_t burstIdx{}; burstIdx < BURST_COUNT; ++burstIdx)
+                    {
+                        for (size_t idx{}; idx < BURST_SIZE; ++idx)
+                        {
+                            const size_t nbBytes{ RandomSize(rng, MIN_SIZE, MAX_SIZE) };
+                            void* pData{};
+                            latencies.Measure([&]() { pData = adapter.Acquire(nbBytes, 16); });
+                            burst.push_back(pData);
+                        }
+
+                        rss.Sample();
+                        if (burstIdx + 1 == BURST_COUNT)
+                            threadFragmentation[threadIdx] = adapter.GetFragmentation();
+
+                        if constexpr (Adapter::HAS_RELEASE)
+                        {
+                            std::shuffle(std::begin(burst), std::end(burst), rng);
+                            for (void* pData : burst)
+                                latencies.Measure([&]() { adapter.Release(pData); });
+                        }
+                        else
+                        {
+                            latencies.Measure([&]() { adapter.Reset(); });
+                        }
+                        burst.clear();
+                    }
+                });
+            }
+
+            for (std::thread& thread : threads)
+                thread.join();
+            const double totalTimeMs{ ElapsedMs(start) };
+
+            LatencyRecorder latencies{};
+            for (const LatencyRecorder& threadLatency : threadLatencies)
+                latencies.Merge(threadLatency);
+
+            return MakeResult("multithreaded_bursts", Adapter::NAME, threadCount, latencies, totalTimeMs, rss, *std::max_element(std::begin(threadFragmentation), std::end(threadFragmentation)));
+        }
+
+        // Job system objects: every thread creates fixed size objects in one shared allocator and half of them are destroyed by the next thread.
+        // Only for thread safe adapters, the hand over between threads is not timed
+        template<typename Adapter>
+        BenchmarkResult RunSharedPoolChurn(uint32_t threadCount, size_t objectSize)
+        {
+            static const size_t ROUND_COUNT{ 200 };
+            static const size_t OBJECTS_PER_ROUND{ 512 };
+
+            RssSampler rss{};
+            std::vector<LatencyRecorder> threadLatencies(threadCount, LatencyRecorder{ ROUND_COUNT * OBJECTS_PER_ROUND * 2 });
+            std::vector<std::vector<void*>> mailboxes(threadCount);
+            std::vector<std::mutex> mailboxLocks(threadCount);
+            std::vector<std::thread> threads{};
+
+            //a thread running ahead of the next one fills its mailbox, the pool is sized for every object of the run so it never runs out
+            Adapter adapter{ threadCount * ROUND_COUNT * OBJECTS_PER_ROUND * objectSize };
+
+            const auto start{ BenchClock::now() };
+            for (uint32_t threadIdx{}; threadIdx < threadCount; ++threadIdx)
+            {
+                threads.emplace_back([&, threadIdx]()
+                {
+                    LatencyRecorder& latencies{ threadLatencies[threadIdx] };
+                    const uint32_t nextThreadIdx{ (threadIdx + 1) % threadCount };
+                    std::vector<void*> round{};
+                    std::vector<void*> received{};
+                    round.reserve(OBJECTS_PER_ROUND);
+
+                    for (size_t roundIdx{}; roundIdx < ROUND_COUNT; ++roundIdx)
+                    {
+                        for (size_t idx{}; idx < OBJECTS_PER_ROUND; ++idx)
+                        {
+                            void* pData{};
+                            latencies.Measure([&]() { pData = adapter.Acquire(objectSize, 16); });
+                            round.push_back(pData);
+                        }
+
+                        {
+                            std::lock_guard<std::mutex> lock{ mailboxLocks[nextThreadIdx] };
+                            mailboxes[nextThreadIdx].insert(std::end(mailboxes[nextThreadIdx]), std::begin(round) + OBJECTS_PER_ROUND / 2, std::end(round));
+                        }
+                        round.resize(OBJECTS_PER_ROUND / 2);
+
+                        {
+                            std::lock_guard<std::mutex> lock{ mailboxLocks[threadIdx] };
+                            received.swap(mailboxes[threadIdx]);
+                        }
+                        round.insert(std::end(round), std::begin(received), std::end(received));
+                        received.clear();
+
+                        for (void* pData : round)
+                            latencies.Measure([&]() { adapter.Release(pData); });
+                        round.clear();
+
+                        if (roundIdx % 16 == 0)
+                            rss.Sample();
+                    }
+                });
+            }
+
+            for (std::thread& thread : threads)
+                thread.join();
+            const double totalTimeMs{ ElapsedMs(start) };
+
+            for (std::vector<void*>& mailbox : mailboxes)
+            {
+                for (void* pData : mailbox)
+                    adapter.Release(pData);
+            }
+
+            LatencyRecorder latencies{};
+            for (const LatencyRecorder& threadLatency : threadLatencies)
+                latencies.Merge(threadLatency);
+
+            return MakeResult("shared_pool_churn", Adapter::NAME, threadCount, latencies, totalTimeMs, rss, adapter.GetFragmentation());
+        }
+    }
+}
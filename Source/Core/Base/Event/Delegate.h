@@ -1,5 +1,6 @@
 #pragma once
 #include <functional>
+#include <memory_resource>
 #include <type_traits>
 #include <map>
 
@@ -50,7 +51,8 @@ namespace SDBX
 	class Event
 	{
 	public:
-		explicit Event() = default;
+		// pResource backs the callback map nodes
+		explicit Event(std::pmr::memory_resource* pResource = std::pmr::get_default_resource()) : m_pCallbacks{ pResource } {}
 
 		void Register(const std::string& evtName, std::function<void(ARG_TYPE...)> pCallback) { m_pCallbacks.emplace(evtName, pCallback); }
 		void Unregister(const std::string evtName)
@@ -64,7 +66,7 @@ namespace SDBX
 		void Invoke(ARG_TYPE...) const;
 
 	private:
-		std::map<std::string, std::function<void(ARG_TYPE...)>> m_pCallbacks;
+		std::pmr::map<std::string, std::function<void(ARG_TYPE...)>> m_pCallbacks;
 	};
 
 	template<typename... ARG_TYPE>
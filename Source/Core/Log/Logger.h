@@ -117,11 +117,15 @@ namespace SDBX
 	#define SDBX_W_ASSERT_AS_WARNING_MSG(exp, msg) SDBX_W_ASSERT_IMP(WARNING_LOG, exp, msg)
 	#define SDBX_W_LOG(logLevel, msg) SDBX::Logger::LogW(SDBX::Logger::LogLevel::##logLevel, msg);
 #else
-	#define SDBX_ASSERT(exp, msg)
-	#define SDBX_ASSERT_AS_WARNING(exp, msg)
+	#define SDBX_ASSERT(exp)
+	#define SDBX_ASSERT_MSG(exp, msg)
+	#define SDBX_ASSERT_AS_WARNING(exp)
+	#define SDBX_ASSERT_AS_WARNING_MSG(exp, msg)
 	#define SDBX_LOG(logLevel, msg)
 
-	#define SDBX_W_ASSERT(exp, msg)
-	#define SDBX_W_ASSERT_AS_WARNING(exp, msg)
+	#define SDBX_W_ASSERT(exp)
+	#define SDBX_W_ASSERT_MSG(exp, msg)
+	#define SDBX_W_ASSERT_AS_WARNING(exp)
+	#define SDBX_W_ASSERT_AS_WARNING_MSG(exp, msg)
 	#define SDBX_W_LOG(logLevel, msg)
 #endif
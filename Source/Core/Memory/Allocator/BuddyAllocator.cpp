@@ -0,0 +1,120 @@
+#include "BuddyAllocator.h"
+
+SDBX::Memory::BuddyOffsetAllocator::BuddyOffsetAllocator(size_t size, size_t minBlockSize)
+	: m_pTree(nullptr)
+	, m_MinBlockSize(minBlockSize)
+	, m_FreeSpace(size)
+	, m_MaxOrder(0)
+	, m_Stats("BuddyOffsetAllocator")
+{
+	SDBX_ASSERT_MSG(Bit::IsPowerOfTwo(minBlockSize) && Bit::IsPowerOfTwo(size) && size >= minBlockSize, "Size and minimum block size must be powers of two")
+
+	const size_t leafCount{ size / minBlockSize };
+	m_MaxOrder = Bit::FindLastSet(leafCount);
+
+	//node 0 is unused so children of n are 2n and 2n + 1, every node starts as one free block of its own order
+	m_pTree = new uint8_t[leafCount * 2];
+	m_pTree[0] = 0;
+	for (uint32_t depth{}; depth <= m_MaxOrder; ++depth)
+	{
+		const uint8_t value{ uint8_t(m_MaxOrder - depth + 1) };
+		for (size_t node{ size_t(1) << depth }; node < size_t(2) << depth; ++node)
+			m_pTree[node] = value;
+	}
+
+	m_Stats.Track(this);
+}
+
+SDBX::Memory::BuddyOffsetAllocator::~BuddyOffsetAllocator()
+{
+	delete[] m_pTree;
+	m_pTree = nullptr;
+}
+
+size_t SDBX::Memory::BuddyOffsetAllocator::Acquire(size_t nbBytes, size_t alignment)
+{
+	SDBX_ASSERT_MSG(IsValidAlignment(alignment), "Alignment must be a power of two")
+
+	const uint32_t order{ GetOrder(nbBytes, alignment) };
+	if (order > m_MaxOrder || m_pTree[1] < order + 1)
+		return INVALID_OFFSET;
+
+	//go down to a node of the requested order, picking the child with the smallest block that still fits to keep large blocks whole
+	size_t node{ 1 };
+	for (uint32_t nodeOrder{ m_MaxOrder }; nodeOrder != order; --nodeOrder)
+	{
+		const uint8_t left{ m_pTree[node * 2] };
+		const uint8_t right{ m_pTree[node * 2 + 1] };
+		const bool isLeftFitting{ left >= order + 1 };
+		const bool isRightFitting{ right >= order + 1 };
+
+		node = node * 2 + ((isRightFitting && (!isLeftFitting || right < left)) ? 1 : 0);
+	}
+
+	m_pTree[node] = 0;
+	UpdateParents(node, order);
+
+	const size_t blockSize{ m_MinBlockSize << order };
+	m_FreeSpace -= blockSize;
+	m_Stats.OnAcquire(blockSize);
+
+	const uint32_t depth{ m_MaxOrder - order };
+	return (node - (size_t(1) << depth)) * blockSize;
+}
+
+void SDBX::Memory::BuddyOffsetAllocator::Release(size_t offset)
+{
+	SDBX_ASSERT_MSG(offset < Capacity() && offset % m_MinBlockSize == 0, "Offset doesn't belong to this allocator")
+
+	//nodes below an allocated block are never touched while it is in use, the first allocated node above the leaf is the block itself
+	size_t node{ (Capacity() + offset) / m_MinBlockSize };
+	uint32_t order{ 0 };
+	while (m_pTree[node] != 0)
+	{
+		SDBX_ASSERT_MSG(node > 1, "Offset released twice")
+		node /= 2;
+		++order;
+	}
+
+	const size_t blockSize{ m_MinBlockSize << order };
+
+	SDBX_ASSERT_MSG(offset % blockSize == 0, "Offset is not the start of an allocated block")
+
+	m_pTree[node] = uint8_t(order + 1);
+	UpdateParents(node, order);
+
+	m_FreeSpace += blockSize;
+	m_Stats.OnRelease(blockSize);
+}
+
+uint32_t SDBX::Memory::BuddyOffsetAllocator::GetOrder(size_t nbBytes, size_t alignment) const
+{
+	//a block is aligned on its own size, asking for a block as large as the alignment is enough
+	const size_t required{ nbBytes > alignment ? nbBytes : alignment };
+	const size_t nbBlocks{ (required + m_MinBlockSize - 1) / m_MinBlockSize };
+	return nbBlocks > 1 ? Bit::FindLastSet(nbBlocks - 1) + 1 : 0;
+}
+
+void SDBX::Memory::BuddyOffsetAllocator::UpdateParents(size_t node, uint32_t order)
+{
+	while (node > 1)
+	{
+		node /= 2;
+		++order;
+
+		//two whole buddies merge back into their parent block, otherwise the parent offers the largest block of its children
+		const uint8_t left{ m_pTree[node * 2] };
+		const uint8_t right{ m_pTree[node * 2 + 1] };
+		m_pTree[node] = (left == order && right == order) ? uint8_t(order + 1) : (left > right ? left : right);
+	}
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+void SDBX::Memory::BuddyOffsetAllocator::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = Capacity();
+	snapshot.freeBytes = GetFreeSpaceAmount();
+	snapshot.largestFreeBlock = GetLargestFreeBlock();
+	snapshot.fragmentation = ComputeFragmentation(snapshot.largestFreeBlock, snapshot.freeBytes);
+}
+#endif
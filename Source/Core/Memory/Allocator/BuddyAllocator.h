@@ -0,0 +1,181 @@
+#pragma once
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
+
+namespace SDBX
+{
+	namespace Memory
+	{
+		static const size_t DEFAULT_BUDDY_MIN_BLOCKSIZE = 256;
+
+		//Buddy system over an abstract range [0, size[, it owns no memory so it can manage GPU heaps, streaming buffers or file ranges.
+		//The range is a complete binary tree of power of two blocks stored as an implicit heap, one byte per node holding (order + 1) of the largest free block in its subtree (0 = nothing free).
+		//Acquire walks down to the best fitting child, Release climbs from the leaf to the first allocated node, both in O(log n), and buddies merge on the way up.
+		//A block of 2^k * minBlockSize bytes starts at an offset that is a multiple of its size, so alignment comes for free up to the block size.
+		class BuddyOffsetAllocator final
+		{
+		public:
+			static const size_t INVALID_OFFSET = SIZE_MAX;
+
+			// size and minBlockSize must be powers of two, size >= minBlockSize
+			explicit BuddyOffsetAllocator(size_t size, size_t minBlockSize = DEFAULT_BUDDY_MIN_BLOCKSIZE);
+			BuddyOffsetAllocator(const BuddyOffsetAllocator& other) = delete;
+			BuddyOffsetAllocator(BuddyOffsetAllocator&& other) noexcept = delete;
+			BuddyOffsetAllocator& operator=(const BuddyOffsetAllocator& other) = delete;
+			BuddyOffsetAllocator& operator=(BuddyOffsetAllocator&& other) noexcept = delete;
+			~BuddyOffsetAllocator();
+
+			// Offset of a block of at least nbBytes aligned on alignment (relative to the start of the range), INVALID_OFFSET when no block fits
+			size_t Acquire(size_t nbBytes, size_t alignment = 1);
+			void Release(size_t offset);
+
+			// Size of the block the request was rounded up to
+			size_t GetBlockSize(size_t nbBytes, size_t alignment = 1) const { return m_MinBlockSize << GetOrder(nbBytes, alignment); }
+
+			size_t Capacity() const { return m_MinBlockSize << m_MaxOrder; }
+			size_t GetMinBlockSize() const { return m_MinBlockSize; }
+			size_t GetFreeSpaceAmount() const { return m_FreeSpace; }
+			size_t GetLargestFreeBlock() const { return m_pTree[1] > 0 ? m_MinBlockSize << (m_pTree[1] - 1) : 0; }
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
+		private:
+			uint8_t* m_pTree;
+			size_t m_MinBlockSize;
+			size_t m_FreeSpace;
+			uint32_t m_MaxOrder;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+
+			uint32_t GetOrder(size_t nbBytes, size_t alignment) const;
+			void UpdateParents(size_t node, uint32_t order);
+		};
+
+		//Object allocator over a BuddyOffsetAllocator, the buffer is aligned on BASE_ALIGNMENT so blocks are naturally aligned up to it.
+		//Requests are rounded up to a power of two block, meant for power of two sized data (streaming chunks, textures, pooled buffers).
+		template<size_t MIN_BLOCKSIZE = DEFAULT_BUDDY_MIN_BLOCKSIZE>
+		class BuddyAllocator final
+		{
+		public:
+			static const size_t BASE_ALIGNMENT = MIN_BLOCKSIZE > 4096 ? MIN_BLOCKSIZE : 4096;
+
+			SDBX_STATIC_ASSERT(Bit::IsPowerOfTwo(MIN_BLOCKSIZE), "MIN_BLOCKSIZE must be a power of two");
+
+			// size must be a power of two multiple of MIN_BLOCKSIZE
+			explicit BuddyAllocator(size_t size, const PageBacking& pageBacking = PageBacking{});
+			BuddyAllocator(const BuddyAllocator& other) = delete;
+			BuddyAllocator(BuddyAllocator&& other) noexcept = delete;
+			BuddyAllocator& operator=(const BuddyAllocator& other) = delete;
+			BuddyAllocator& operator=(BuddyAllocator&& other) noexcept = delete;
+			~BuddyAllocator();
+
+			template<typename Typename, typename... Arg_Type>
+			Typename* Acquire(Arg_Type&&... args);
+
+			// Default construct count contiguous elements, alignment can be raised above alignof(Typename)
+			template<typename Typename>
+			Typename* AcquireArray(size_t count, size_t alignment = alignof(Typename));
+
+			void* Acquire(size_t nbBytes, size_t alignment = alignof(std::max_align_t));
+
+			template<typename Typename>
+			void Release(Typename* pData);
+
+			template<typename Typename>
+			void ReleaseArray(Typename* pFirst, size_t count);
+
+			void Release(void* pData);
+
+			size_t Capacity() const { return m_Offsets.Capacity(); }
+			size_t GetFreeSpaceAmount() const { return m_Offsets.GetFreeSpaceAmount(); }
+			size_t GetLargestFreeBlock() const { return m_Offsets.GetLargestFreeBlock(); }
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Offsets.SetStatsInfo(name, tag); }
+
+		private:
+			char* m_pBuffer;
+			PageBacking m_PageBacking;
+			BuddyOffsetAllocator m_Offsets;
+		};
+	}
+}
+
+template<size_t MIN_BLOCKSIZE>
+SDBX::Memory::BuddyAllocator<MIN_BLOCKSIZE>::BuddyAllocator(size_t size, const PageBacking& pageBacking)
+	: m_pBuffer(static_cast<char*>(AcquireBackingMemory(size, BASE_ALIGNMENT, pageBacking)))
+	, m_PageBacking(pageBacking)
+	, m_Offsets(size, MIN_BLOCKSIZE)
+{
+	SDBX_ASSERT_MSG(m_pBuffer != nullptr, "Failed to get the buddy memory")
+	m_Offsets.SetStatsInfo("BuddyAllocator", MemoryTag::General);
+}
+
+template<size_t MIN_BLOCKSIZE>
+SDBX::Memory::BuddyAllocator<MIN_BLOCKSIZE>::~BuddyAllocator()
+{
+	ReleaseBackingMemory(m_pBuffer, m_Offsets.Capacity(), BASE_ALIGNMENT, m_PageBacking);
+	m_pBuffer = nullptr;
+}
+
+template<size_t MIN_BLOCKSIZE>
+template<typename Typename, typename... Arg_Type>
+Typename* SDBX::Memory::BuddyAllocator<MIN_BLOCKSIZE>::Acquire(Arg_Type&&... args)
+{
+	void* pData{ Acquire(sizeof(Typename), alignof(Typename)) };
+	return new (pData) Typename(std::forward<Arg_Type>(args)...);
+}
+
+template<size_t MIN_BLOCKSIZE>
+template<typename Typename>
+Typename* SDBX::Memory::BuddyAllocator<MIN_BLOCKSIZE>::AcquireArray(size_t count, size_t alignment)
+{
+	void* pData{ Acquire(sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename)) };
+	return ConstructArray<Typename>(pData, count);
+}
+
+template<size_t MIN_BLOCKSIZE>
+void* SDBX::Memory::BuddyAllocator<MIN_BLOCKSIZE>::Acquire(size_t nbBytes, size_t alignment)
+{
+	SDBX_ASSERT_MSG(alignment <= BASE_ALIGNMENT, "Alignment is larger than the buffer alignment")
+
+	const size_t offset{ m_Offsets.Acquire(nbBytes, alignment) };
+
+	SDBX_ASSERT_MSG(offset != BuddyOffsetAllocator::INVALID_OFFSET, "Allocator out of memory")
+
+	return m_pBuffer + offset;
+}
+
+template<size_t MIN_BLOCKSIZE>
+template<typename Typename>
+void SDBX::Memory::BuddyAllocator<MIN_BLOCKSIZE>::Release(Typename* pData)
+{
+	pData->~Typename();
+	Release(static_cast<void*>(pData));
+}
+
+template<size_t MIN_BLOCKSIZE>
+template<typename Typename>
+void SDBX::Memory::BuddyAllocator<MIN_BLOCKSIZE>::ReleaseArray(Typename* pFirst, size_t count)
+{
+	DestroyArray(pFirst, count);
+	Release(static_cast<void*>(pFirst));
+}
+
+template<size_t MIN_BLOCKSIZE>
+void SDBX::Memory::BuddyAllocator<MIN_BLOCKSIZE>::Release(void* pData)
+{
+	SDBX_ASSERT_MSG(pData >= m_pBuffer && pData < m_pBuffer + Capacity(), "Data doesn't belong to this allocator")
+
+	m_Offsets.Release(size_t(static_cast<char*>(pData) - m_pBuffer));
+}
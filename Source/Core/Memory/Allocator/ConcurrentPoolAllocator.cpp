@@ -0,0 +1,59 @@
+#include "ConcurrentPoolAllocator.h"
+
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	//indices of the threads that finished, reused first so magazines keep being used and the slots parked in them are not lost
+	struct ThreadIndexRegistry
+	{
+		std::mutex mutex;
+		std::vector<uint32_t> freeIndices;
+		uint32_t nextIndex;
+	};
+
+	ThreadIndexRegistry& GetThreadIndexRegistry()
+	{
+		static ThreadIndexRegistry registry{};
+		return registry;
+	}
+
+	//the registry mutex also orders the last magazine accesses of a finished thread before the first ones of the thread taking its index
+	struct ThreadIndex
+	{
+		ThreadIndex()
+			: index(SDBX::Memory::NO_POOL_THREAD_CACHE)
+		{
+			ThreadIndexRegistry& registry{ GetThreadIndexRegistry() };
+			std::lock_guard<std::mutex> lock{ registry.mutex };
+			if (!registry.freeIndices.empty())
+			{
+				index = registry.freeIndices.back();
+				registry.freeIndices.pop_back();
+			}
+			else if (registry.nextIndex < SDBX::Memory::MAX_POOL_THREAD_CACHES)
+			{
+				index = registry.nextIndex++;
+			}
+		}
+
+		~ThreadIndex()
+		{
+			if (index == SDBX::Memory::NO_POOL_THREAD_CACHE)
+				return;
+
+			ThreadIndexRegistry& registry{ GetThreadIndexRegistry() };
+			std::lock_guard<std::mutex> lock{ registry.mutex };
+			registry.freeIndices.push_back(index);
+		}
+
+		uint32_t index;
+	};
+}
+
+uint32_t SDBX::Memory::GetPoolThreadIndex()
+{
+	thread_local const ThreadIndex threadIndex{};
+	return threadIndex.index;
+}
@@ -0,0 +1,343 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
+
+//Thread safe pool of Typename slots, usable from any thread without a mutex.
+//Every thread owns a small magazine of free slot indices per pool, Acquire and Release only touch that magazine in the common case.
+//Magazines exchange slots with a shared lock-free stack of batches: a full magazine gives back half of its slots, an empty one takes a whole batch.
+//An object can be released by any thread, the slot simply ends up in the magazine of the releasing thread.
+namespace SDBX
+{
+	namespace Memory
+	{
+		// Threads past that count work on the shared stack directly, they are still correct but no longer scale
+		const uint32_t MAX_POOL_THREAD_CACHES{ 64 };
+		const uint32_t NO_POOL_THREAD_CACHE{ UINT32_MAX };
+
+		// Index of the calling thread magazine, shared by every pool. Indices of finished threads are handed to new ones,
+		// NO_POOL_THREAD_CACHE once MAX_POOL_THREAD_CACHES threads are alive
+		uint32_t GetPoolThreadIndex();
+
+		template<typename Typename, size_t MAGAZINE_SIZE = 64>
+		class ConcurrentPoolAllocator final
+		{
+		public:
+			explicit ConcurrentPoolAllocator(size_t maxElementCount, const PageBacking& pageBacking = PageBacking{});
+			ConcurrentPoolAllocator(const ConcurrentPoolAllocator& other) = delete;
+			ConcurrentPoolAllocator(ConcurrentPoolAllocator&& other) noexcept = delete;
+			ConcurrentPoolAllocator& operator=(const ConcurrentPoolAllocator& other) = delete;
+			ConcurrentPoolAllocator& operator=(ConcurrentPoolAllocator&& other) noexcept = delete;
+			// Objects still alive are not destroyed, release them before the pool goes away
+			~ConcurrentPoolAllocator();
+
+			// Returns nullptr when no slot is left. Slots parked in the magazines of other threads count as used
+			template<typename... Arg_Type>
+			Typename* Acquire(Arg_Type&&... args);
+
+			// Can be called from any thread, not only the one that acquired pElement. Slots are never moved, pointers stay valid
+			void Release(Typename* pElement);
+
+			// Exact when no other thread is acquiring or releasing
+			size_t Size() const;
+			size_t Capacity() const { return m_BufferSize; };
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
+		private:
+			static const uint32_t NO_SLOT = UINT32_MAX;
+			static const uint32_t BATCH_SIZE = uint32_t(MAGAZINE_SIZE / 2);
+
+			SDBX_STATIC_ASSERT(BATCH_SIZE > 0, "A magazine must hold at least two slots");
+
+			//a free slot holds the next slot of its batch, the link to the next batch lives in m_pNextBatch so the shared stack never reads slot memory
+			union Slot
+			{
+				alignas(Typename) unsigned char storage[sizeof(Typename)];
+				uint32_t nextSlot;
+			};
+
+			//only the owning thread writes a magazine, the counters are atomics so Size can read them from anywhere.
+			//aligned on a cache line so neighbouring threads don't share one
+			struct alignas(64) ThreadCache
+			{
+				uint32_t slots[MAGAZINE_SIZE];
+				uint32_t count;
+				std::atomic<size_t> acquireCount;
+				std::atomic<size_t> releaseCount;
+			};
+
+			//the head of the batch stack packs a tag with the slot index, the tag changes on every update so a head that was popped and pushed back (ABA) fails the compare exchange
+			inline static uint64_t PackHead(uint32_t tag, uint32_t slotIdx) { return (uint64_t(tag) << 32) | slotIdx; }
+			inline static uint32_t GetHeadTag(uint64_t head) { return uint32_t(head >> 32); }
+			inline static uint32_t GetHeadSlot(uint64_t head) { return uint32_t(head); }
+
+			//single writer counter, a plain load and store is enough and avoids a locked instruction
+			inline static void Increment(std::atomic<size_t>& counter) { counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+			void PushBatch(uint32_t firstSlot);
+			uint32_t PopBatch();
+			//claims up to count never used slots, returns how many were claimed starting at firstSlot
+			uint32_t ClaimUnused(uint32_t count, uint32_t& firstSlot);
+			void Refill(ThreadCache& cache);
+			void Flush(ThreadCache& cache);
+			uint32_t AcquireShared();
+			void ReleaseShared(uint32_t slotIdx);
+
+			Slot* m_pSlots;
+			std::atomic<uint32_t>* m_pNextBatch;
+			ThreadCache* m_pCaches;
+			size_t m_BufferSize;
+			alignas(64) std::atomic<uint64_t> m_BatchHead;
+			alignas(64) std::atomic<uint32_t> m_NextUnused;
+			//threads without a magazine
+			alignas(64) std::atomic<size_t> m_SharedAcquireCount;
+			std::atomic<size_t> m_SharedReleaseCount;
+			PageBacking m_PageBacking;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+		};
+	}
+}
+
+//slots are not constructed up front, they are handed out from the start of the buffer the first time and from the free batches afterwards
+template<typename Typename, size_t MAGAZINE_SIZE>
+SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::ConcurrentPoolAllocator(size_t maxElementCount, const PageBacking& pageBacking)
+	: m_pSlots(nullptr)
+	, m_pNextBatch(nullptr)
+	, m_pCaches(nullptr)
+	, m_BufferSize(maxElementCount)
+	, m_BatchHead(PackHead(0, NO_SLOT))
+	, m_NextUnused(0)
+	, m_SharedAcquireCount(0)
+	, m_SharedReleaseCount(0)
+	, m_PageBacking(pageBacking)
+	, m_Stats("ConcurrentPoolAllocator")
+{
+	SDBX_ASSERT_MSG(maxElementCount < NO_SLOT, "Slots are addressed on 32 bits")
+
+	m_pSlots = static_cast<Slot*>(AcquireBackingMemory(sizeof(Slot) * maxElementCount, alignof(Slot), m_PageBacking));
+	SDBX_ASSERT_MSG(m_pSlots != nullptr, "Failed to get the pool memory")
+
+	m_pNextBatch = new std::atomic<uint32_t>[maxElementCount];
+	m_pCaches = new ThreadCache[MAX_POOL_THREAD_CACHES];
+	for (uint32_t cacheIdx{}; cacheIdx < MAX_POOL_THREAD_CACHES; ++cacheIdx)
+	{
+		m_pCaches[cacheIdx].count = 0;
+		m_pCaches[cacheIdx].acquireCount.store(0, std::memory_order_relaxed);
+		m_pCaches[cacheIdx].releaseCount.store(0, std::memory_order_relaxed);
+	}
+
+	m_Stats.Track(this);
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::~ConcurrentPoolAllocator()
+{
+	SDBX_ASSERT_MSG(Size() == 0, "Pool destroyed with live objects, their destructors are not run")
+
+	delete[] m_pCaches;
+	delete[] m_pNextBatch;
+	ReleaseBackingMemory(m_pSlots, sizeof(Slot) * m_BufferSize, alignof(Slot), m_PageBacking);
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+template<typename... Arg_Type>
+Typename* SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::Acquire(Arg_Type&&... args)
+{
+	uint32_t slotIdx{ NO_SLOT };
+
+	const uint32_t threadIdx{ GetPoolThreadIndex() };
+	if (threadIdx != NO_POOL_THREAD_CACHE)
+	{
+		ThreadCache& cache{ m_pCaches[threadIdx] };
+		if (cache.count == 0)
+			Refill(cache);
+
+		if (cache.count > 0)
+		{
+			slotIdx = cache.slots[--cache.count];
+			Increment(cache.acquireCount);
+		}
+	}
+	else
+	{
+		slotIdx = AcquireShared();
+	}
+
+	SDBX_ASSERT_MSG(slotIdx != NO_SLOT, "Allocator out of memory")
+	if (slotIdx == NO_SLOT)
+		return nullptr;
+
+	return new (m_pSlots[slotIdx].storage) Typename(std::forward<Arg_Type>(args)...);
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+void SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::Release(Typename* pElement)
+{
+	Slot* pSlot{ reinterpret_cast<Slot*>(pElement) };
+	SDBX_ASSERT_MSG(pSlot >= m_pSlots && pSlot < m_pSlots + m_BufferSize, "Element does not belong to this pool")
+
+	pElement->~Typename();
+	const uint32_t slotIdx{ uint32_t(pSlot - m_pSlots) };
+
+	const uint32_t threadIdx{ GetPoolThreadIndex() };
+	if (threadIdx == NO_POOL_THREAD_CACHE)
+	{
+		ReleaseShared(slotIdx);
+		return;
+	}
+
+	ThreadCache& cache{ m_pCaches[threadIdx] };
+	if (cache.count == MAGAZINE_SIZE)
+		Flush(cache);
+
+	cache.slots[cache.count++] = slotIdx;
+	Increment(cache.releaseCount);
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+size_t SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::Size() const
+{
+	size_t acquireCount{ m_SharedAcquireCount.load(std::memory_order_relaxed) };
+	size_t releaseCount{ m_SharedReleaseCount.load(std::memory_order_relaxed) };
+	for (uint32_t cacheIdx{}; cacheIdx < MAX_POOL_THREAD_CACHES; ++cacheIdx)
+	{
+		acquireCount += m_pCaches[cacheIdx].acquireCount.load(std::memory_order_relaxed);
+		releaseCount += m_pCaches[cacheIdx].releaseCount.load(std::memory_order_relaxed);
+	}
+
+	//an object released on another thread than the one that acquired it can be counted before its acquire while threads are running
+	return acquireCount > releaseCount ? acquireCount - releaseCount : 0;
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+void SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::PushBatch(uint32_t firstSlot)
+{
+	//release so the thread popping the batch sees the slot links written before the push
+	uint64_t head{ m_BatchHead.load(std::memory_order_relaxed) };
+	do
+	{
+		m_pNextBatch[firstSlot].store(GetHeadSlot(head), std::memory_order_relaxed);
+	} while (!m_BatchHead.compare_exchange_weak(head, PackHead(GetHeadTag(head) + 1, firstSlot), std::memory_order_release, std::memory_order_relaxed));
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+uint32_t SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::PopBatch()
+{
+	//the next batch link can be rewritten by a thread that popped and pushed the head in the meantime, the tag then makes the exchange fail
+	uint64_t head{ m_BatchHead.load(std::memory_order_acquire) };
+	while (GetHeadSlot(head) != NO_SLOT)
+	{
+		const uint32_t nextBatch{ m_pNextBatch[GetHeadSlot(head)].load(std::memory_order_relaxed) };
+		if (m_BatchHead.compare_exchange_weak(head, PackHead(GetHeadTag(head) + 1, nextBatch), std::memory_order_acquire, std::memory_order_acquire))
+			return GetHeadSlot(head);
+	}
+
+	return NO_SLOT;
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+uint32_t SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::ClaimUnused(uint32_t count, uint32_t& firstSlot)
+{
+	uint32_t nextUnused{ m_NextUnused.load(std::memory_order_relaxed) };
+	uint32_t claimedCount{};
+	do
+	{
+		claimedCount = uint32_t(std::min(size_t(count), m_BufferSize - nextUnused));
+		if (claimedCount == 0)
+			return 0;
+	} while (!m_NextUnused.compare_exchange_weak(nextUnused, nextUnused + claimedCount, std::memory_order_relaxed));
+
+	firstSlot = nextUnused;
+	return claimedCount;
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+void SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::Refill(ThreadCache& cache)
+{
+	for (uint32_t slotIdx{ PopBatch() }; slotIdx != NO_SLOT; slotIdx = m_pSlots[slotIdx].nextSlot)
+		cache.slots[cache.count++] = slotIdx;
+
+	if (cache.count > 0)
+		return;
+
+	//pushed in reverse so fresh slots are handed out front to back
+	uint32_t firstSlot{};
+	const uint32_t claimedCount{ ClaimUnused(BATCH_SIZE, firstSlot) };
+	for (uint32_t offset{ claimedCount }; offset > 0; --offset)
+		cache.slots[cache.count++] = firstSlot + offset - 1;
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+void SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::Flush(ThreadCache& cache)
+{
+	//the oldest slots leave, the most recently released ones are still warm in this core's cache
+	for (uint32_t idx{}; idx < BATCH_SIZE; ++idx)
+		m_pSlots[cache.slots[idx]].nextSlot = idx + 1 < BATCH_SIZE ? cache.slots[idx + 1] : NO_SLOT;
+
+	PushBatch(cache.slots[0]);
+
+	std::copy(cache.slots + BATCH_SIZE, cache.slots + cache.count, cache.slots);
+	cache.count -= BATCH_SIZE;
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+uint32_t SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::AcquireShared()
+{
+	uint32_t slotIdx{ PopBatch() };
+	if (slotIdx != NO_SLOT)
+	{
+		//keep one slot, the rest of the batch goes back on the stack
+		if (m_pSlots[slotIdx].nextSlot != NO_SLOT)
+			PushBatch(m_pSlots[slotIdx].nextSlot);
+	}
+	else if (ClaimUnused(1, slotIdx) == 0)
+	{
+		return NO_SLOT;
+	}
+
+	m_SharedAcquireCount.fetch_add(1, std::memory_order_relaxed);
+	return slotIdx;
+}
+
+template<typename Typename, size_t MAGAZINE_SIZE>
+void SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::ReleaseShared(uint32_t slotIdx)
+{
+	m_pSlots[slotIdx].nextSlot = NO_SLOT;
+	PushBatch(slotIdx);
+	m_SharedReleaseCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+//AllocatorStats is single threaded, the usage is rebuilt from the per thread counters instead
+template<typename Typename, size_t MAGAZINE_SIZE>
+void SDBX::Memory::ConcurrentPoolAllocator<Typename, MAGAZINE_SIZE>::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	size_t totalAllocations{ m_SharedAcquireCount.load(std::memory_order_relaxed) };
+	for (uint32_t cacheIdx{}; cacheIdx < MAX_POOL_THREAD_CACHES; ++cacheIdx)
+		totalAllocations += m_pCaches[cacheIdx].acquireCount.load(std::memory_order_relaxed);
+
+	const size_t liveCount{ Size() };
+	snapshot.capacity = m_BufferSize * sizeof(Slot);
+	snapshot.currentBytes = liveCount * sizeof(Slot);
+	//slots that were ever handed out, an upper bound of the peak
+	snapshot.peakBytes = m_NextUnused.load(std::memory_order_relaxed) * sizeof(Slot);
+	snapshot.liveAllocations = liveCount;
+	snapshot.totalAllocations = totalAllocations;
+	snapshot.freeBytes = (m_BufferSize - liveCount) * sizeof(Slot);
+	snapshot.largestFreeBlock = liveCount < m_BufferSize ? sizeof(Slot) : 0;
+	snapshot.fragmentation = 0.f;
+}
+#endif
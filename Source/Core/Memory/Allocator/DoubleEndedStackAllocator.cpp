@@ -0,0 +1,90 @@
+#include "DoubleEndedStackAllocator.h"
+
+SDBX::Memory::DoubleEndedStackAllocator::DoubleEndedStackAllocator(const size_t size, const PageBacking& pageBacking)
+	: m_pBegin(static_cast<char*>(AcquireBackingMemory(size, alignof(std::max_align_t), pageBacking)))
+	, m_pEnd(nullptr)
+	, m_pBottom(nullptr)
+	, m_pTop(nullptr)
+	, m_PageBacking(pageBacking)
+	, m_Stats("DoubleEndedStackAllocator")
+{
+	SDBX_ASSERT_MSG(m_pBegin != nullptr, "Failed to get the stack memory")
+
+	m_pEnd = m_pBegin + size;
+	m_pBottom = m_pBegin;
+	m_pTop = m_pEnd;
+	m_Stats.Track(this);
+}
+
+SDBX::Memory::DoubleEndedStackAllocator::~DoubleEndedStackAllocator()
+{
+	ReleaseBackingMemory(m_pBegin, size_t(m_pEnd - m_pBegin), alignof(std::max_align_t), m_PageBacking);
+}
+
+void SDBX::Memory::DoubleEndedStackAllocator::FreeToMarker(End end, const Marker marker)
+{
+	if (end == End::Bottom)
+	{
+		SDBX_ASSERT_MSG(marker >= m_pBegin && marker <= m_pBottom, "Marker doesn't belong to the bottom stack")
+		m_Stats.OnRelease(size_t(m_pBottom - marker), 0);
+		m_pBottom = marker;
+	}
+	else
+	{
+		SDBX_ASSERT_MSG(marker >= m_pTop && marker <= m_pEnd, "Marker doesn't belong to the top stack")
+		m_Stats.OnRelease(size_t(marker - m_pTop), 0);
+		m_pTop = marker;
+	}
+}
+
+void* SDBX::Memory::DoubleEndedStackAllocator::Acquire(End end, size_t nbBytes, size_t alignment)
+{
+	SDBX_ASSERT_MSG(IsValidAlignment(alignment), "Alignment must be a power of two")
+
+	[[maybe_unused]] const size_t freeSpace{ GetFreeSpaceAmount() };
+	if (end == End::Bottom)
+	{
+		const size_t padding{ size_t(AlignUp(m_pBottom, alignment) - m_pBottom) };
+
+		SDBX_ASSERT_MSG(freeSpace >= nbBytes + padding, "Allocator out of memory")
+
+		m_Stats.OnStackAcquire(nbBytes + padding);
+		void* acquiredMemory{ static_cast<void*>(m_pBottom + padding) };
+		m_pBottom += nbBytes + padding;
+		return acquiredMemory;
+	}
+
+	//the top stack grows down, the block start is rounded down to the alignment and the padding ends up above it
+	SDBX_ASSERT_MSG(freeSpace >= nbBytes, "Allocator out of memory")
+
+	const uintptr_t blockStart{ (reinterpret_cast<uintptr_t>(m_pTop) - nbBytes) & ~(uintptr_t(alignment) - 1) };
+	const size_t taken{ size_t(reinterpret_cast<uintptr_t>(m_pTop) - blockStart) };
+
+	SDBX_ASSERT_MSG(freeSpace >= taken, "Allocator out of memory")
+
+	m_Stats.OnStackAcquire(taken);
+	m_pTop -= taken;
+	return static_cast<void*>(m_pTop);
+}
+
+void SDBX::Memory::DoubleEndedStackAllocator::Reset(End end)
+{
+	FreeToMarker(end, end == End::Bottom ? m_pBegin : m_pEnd);
+}
+
+void SDBX::Memory::DoubleEndedStackAllocator::Reset()
+{
+	m_pBottom = m_pBegin;
+	m_pTop = m_pEnd;
+	m_Stats.OnReset();
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+void SDBX::Memory::DoubleEndedStackAllocator::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = size_t(m_pEnd - m_pBegin);
+	snapshot.freeBytes = GetFreeSpaceAmount();
+	snapshot.largestFreeBlock = GetFreeSpaceAmount();
+	snapshot.fragmentation = 0.f;
+}
+#endif
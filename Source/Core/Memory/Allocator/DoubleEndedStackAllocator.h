@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+
+#include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
+
+//FOR POD ONLY, DOESN'T HANDLE NON POD RELEASE
+//Two stacks sharing one buffer, the bottom one grows up from the start and the top one grows down from the end.
+//Typically long lived level data goes on one end and load time scratch on the other, whatever one side doesn't use is left to the other.
+namespace SDBX
+{
+	namespace Memory
+	{
+		class DoubleEndedStackAllocator final
+		{
+		public:
+			enum class End
+			{
+				Bottom,
+				Top
+			};
+
+			explicit DoubleEndedStackAllocator(size_t size, const PageBacking& pageBacking = PageBacking{});
+			~DoubleEndedStackAllocator();
+			DoubleEndedStackAllocator(const DoubleEndedStackAllocator& other) = delete;
+			DoubleEndedStackAllocator(DoubleEndedStackAllocator&& other) noexcept = delete;
+			DoubleEndedStackAllocator& operator=(const DoubleEndedStackAllocator& other) = delete;
+			DoubleEndedStackAllocator& operator=(DoubleEndedStackAllocator&& other) noexcept = delete;
+
+			using Marker = char*;
+
+			// Get a marker to the current top of the given stack, a marker is only valid for the end it was taken from
+			inline Marker GetMarker(End end) const { return end == End::Bottom ? m_pBottom : m_pTop; }
+
+			// Free the memory of the given stack up to the marker
+			void FreeToMarker(End end, Marker marker);
+
+			template<typename Typename, typename... Arg_Type, typename = std::enable_if_t<std::is_trivially_destructible_v<Typename>>>
+			Typename* Acquire(End end, Arg_Type&&... args)
+			{
+				void* acquiredMemory{ Acquire(end, sizeof(Typename), alignof(Typename)) };
+				return new (acquiredMemory) Typename(std::forward<Arg_Type>(args)...);
+			}
+
+			// Default construct count contiguous elements, alignment can be raised above alignof(Typename)
+			template<typename Typename, typename = std::enable_if_t<std::is_trivially_destructible_v<Typename>>>
+			Typename* AcquireArray(End end, size_t count, size_t alignment = alignof(Typename))
+			{
+				void* acquiredMemory{ Acquire(end, sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename)) };
+				return ConstructArray<Typename>(acquiredMemory, count);
+			}
+
+			// Acquire raw memory from the given end, the block start is aligned in both directions
+			void* Acquire(End end, size_t nbBytes, size_t alignment = 1);
+
+			// Reset a single stack, the other one is left untouched
+			void Reset(End end);
+
+			// Reset both stacks
+			void Reset();
+
+			// Get the amount of free memory left between the two stacks.
+			inline size_t GetFreeSpaceAmount() const { return size_t(m_pTop - m_pBottom); }
+
+			// Memory currently held by the given stack
+			inline size_t GetUsedAmount(End end) const { return end == End::Bottom ? size_t(m_pBottom - m_pBegin) : size_t(m_pEnd - m_pTop); }
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
+		private:
+			char* m_pBegin;
+			char* m_pEnd;
+			char* m_pBottom;
+			char* m_pTop;
+			PageBacking m_PageBacking;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+		};
+	}
+}
@@ -1,14 +1,35 @@
- #pragma once
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "Core/Log/Logger.h"
+#include "Core/Memory/Allocator/HandlePool.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
+#include "Core/Misc/Bit/BitUtils.h"
 
 namespace SDBX
 {
 	namespace Memory
 	{
-		static const size_t DEFAULT_DL_BLOCKSIZE = 16;
+		static const size_t DEFAULT_DL_BLOCKSIZE = 32;
 
+		// Specialize to true for types that stay valid when their bytes are moved somewhere else (no pointer to themselves, address not registered anywhere).
+		// Other relocatable types are moved with their move constructor, which needs the old and new location not to overlap.
+		template<typename Typename>
+		struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<Typename>> {};
+
+		//Every block is framed by boundary tags: the header at its start and a copy of it (footer) in its last bytes.
+		//Release reads the header of the right neighbor and the footer of the left neighbor to merge free blocks immediately.
+		//Free blocks are sorted in the same power of two size classes as the SinglyLinkedAllocator, a bitmap of the non empty bins finds a fitting block with a single bit scan.
+		//Over-aligned data is pushed forward inside its block, the word right before it is then a padding tag (isFree set) holding the distance to the header.
+		//Objects acquired through a handle are relocatable: Defragment slides them down into the free block before them and patches the handle table,
+		//a few steps per call so the compaction can be spread over frames. Blocks acquired by pointer are pinned, the compaction goes around them.
 		template<size_t BLOCKSIZE = DEFAULT_DL_BLOCKSIZE>
 		class DoublyLinkedAllocator final
 		{
@@ -17,7 +38,8 @@ namespace SDBX
 			struct Header
 			{
 				size_t isFree : 1;
-				size_t blockCount : sizeof(size_t) - 1;
+				size_t isRelocatable : 1;
+				size_t blockCount : sizeof(size_t) * 8 - 2;
 			};
 
 			struct Block : Header
@@ -34,7 +56,10 @@ namespace SDBX
 				};
 			};
 
-			explicit DoublyLinkedAllocator(size_t nbrBlocks = 0);
+			SDBX_STATIC_ASSERT(BLOCKSIZE >= sizeof(Header) * 2 + sizeof(typename Block::Links), "BLOCKSIZE is too small to store a free block and its footer");
+			SDBX_STATIC_ASSERT(BLOCKSIZE % alignof(Header) == 0, "BLOCKSIZE must be a multiple of the header alignment");
+
+			explicit DoublyLinkedAllocator(size_t nbrBlocks = 0, const PageBacking& pageBacking = PageBacking{});
 			DoublyLinkedAllocator(const DoublyLinkedAllocator& other) = delete;
 			DoublyLinkedAllocator(DoublyLinkedAllocator&& other) noexcept = delete;
 			DoublyLinkedAllocator& operator=(const DoublyLinkedAllocator& other) = delete;
@@ -44,114 +69,583 @@ namespace SDBX
 			template<typename Typename, typename... Arg_Type>
 			Typename* Acquire(Arg_Type&&... args);
 
+			// Default construct count contiguous elements, alignment can be raised above alignof(Typename)
+			template<typename Typename>
+			Typename* AcquireArray(size_t count, size_t alignment = alignof(Typename));
+
+			void* Acquire(size_t nbBytes, size_t alignment = alignof(Header));
+
 			template<typename Typename>
 			void Release(Typename* pData);
 
+			template<typename Typename>
+			void ReleaseArray(Typename* pFirst, size_t count);
+
+			void Release(void* pData);
+
+			// Relocatable objects, the handle is invalid when the allocator is out of memory. The pointer returned by Get is only valid until the next Defragment
+			template<typename Typename, typename... Arg_Type>
+			Handle AcquireRelocatable(Arg_Type&&... args);
+
+			template<typename Typename>
+			Handle AcquireRelocatableArray(size_t count, size_t alignment = alignof(Typename));
+
+			void ReleaseRelocatable(Handle handle);
+
+			bool IsValid(Handle handle) const { return handle.index < m_Relocatables.size() && handle.generation != 0 && m_Relocatables[handle.index].generation == handle.generation; }
+
+			template<typename Typename>
+			Typename* Get(Handle handle) const { return IsValid(handle) ? static_cast<Typename*>(m_Relocatables[handle.index].pData) : nullptr; }
+
+			// Move relocatable blocks down into the free space until the budget is spent, the work resumes where it stopped on the next call.
+			// Returns true once a pass reached the end of the buffer, every relocatable block is then packed against the one before it.
+			bool Defragment(std::chrono::microseconds budget);
+
+			// Free bytes and size of the largest free block, both walk the free lists
+			size_t GetFreeSpaceAmount() const;
+			size_t GetLargestFreeBlock() const;
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
 		private:
+			static const uint32_t NO_SLOT = UINT32_MAX;
+			static const uint32_t BIN_COUNT = sizeof(size_t) * 8;
+
+			//moves count objects to a new location and destroys the old ones
+			using RelocateFnc = void (*)(void* pDestination, void* pSource, size_t count);
+			using DestroyFnc = void (*)(void* pData, size_t count);
+
+			//the free slot index is kept in nextFree while the entry isn't used
+			struct RelocatableEntry
+			{
+				void* pData;
+				RelocateFnc pRelocate;
+				DestroyFnc pDestroy;
+				size_t count;
+				size_t nbBytes;
+				size_t alignment;
+				uint32_t generation;
+				uint32_t nextFree;
+				bool canOverlap;
+			};
+
+			//first word of a relocatable block, leaves the word before the data free for the padding tag
+			struct RelocationTag
+			{
+				size_t entryIndex;
+				Header paddingSpace;
+			};
+
 			Block* m_pHead;
 			size_t m_BufferSize;
+			uint64_t m_BinMask;
+			Block* m_Bins[BIN_COUNT];
+			PageBacking m_PageBacking;
+			std::vector<RelocatableEntry> m_Relocatables;
+			uint32_t m_FreeEntry;
+			Block* m_pDefragCursor;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+
+			Block* GetBlock(void* pData) const;
+			Block* FindFreeBlock(size_t nbBlocks) const;
+			void InsertFree(Block* pBlock);
+			void RemoveFree(Block* pBlock);
+
+			Block* AcquireBlock(size_t nbBlocks);
+			static char* PlaceRelocatable(Block* pBlock, size_t entryIndex, size_t alignment);
+			Handle AddRelocatable(size_t nbBytes, size_t alignment, size_t count, RelocateFnc pRelocate, DestroyFnc pDestroy, bool canOverlap);
+			bool RelocateNext();
+
+			template<typename Typename>
+			static void Relocate(void* pDestination, void* pSource, size_t count);
+			template<typename Typename>
+			static void Destroy(void* pData, size_t count) { DestroyArray(static_cast<Typename*>(pData), count); }
 
-			void InsertAfter(Block& firstBlock, Block& secondBlock);
-			void UnLink(Block& block);
+			inline static size_t GetBlockCount(size_t nbBytes, size_t alignment);
+			inline static uint32_t GetBin(size_t nbBlocks) { return Bit::FindLastSet(nbBlocks); }
+			inline static Header* GetFooter(Block* pBlock) { return reinterpret_cast<Header*>(pBlock + pBlock->blockCount) - 1; }
+			inline static void SetTags(Block* pBlock, size_t blockCount, bool isFree, bool isRelocatable = false);
 		};
 	}
 }
 
 template<size_t BLOCKSIZE>
-SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::DoublyLinkedAllocator(size_t nbrBlocks)
+SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::DoublyLinkedAllocator(size_t nbrBlocks, const PageBacking& pageBacking)
 	: m_pHead(nullptr)
 	, m_BufferSize()
+	, m_BinMask()
+	, m_Bins()
+	, m_PageBacking(pageBacking)
+	, m_Relocatables()
+	, m_FreeEntry(NO_SLOT)
+	, m_pDefragCursor(nullptr)
+	, m_Stats("DoublyLinkedAllocator")
 {
 	m_BufferSize = nbrBlocks;
 
-	//allocate one extra block for the head
-	m_pHead = new Block[nbrBlocks + 1];
+	//allocate one extra block for the head and one for the tail, they are never free so the neighbor checks don't need bounds checks
+	m_pHead = static_cast<Block*>(AcquireBackingMemory(sizeof(Block) * (nbrBlocks + 2), alignof(Block), m_PageBacking));
 
 	if (m_pHead)
 	{
-		m_pHead->blockCount = 0;
-		m_pHead->isFree = false;
-		Block* pNext{ m_pHead + 1 };
-		pNext->blockCount = m_BufferSize;
-		pNext->link.next = pNext->link.prev = m_pHead;
-		pNext->isFree = true;
-		m_pHead->link.next = m_pHead->link.prev = pNext;
+		SetTags(m_pHead, 1, false);
+		SetTags(m_pHead + nbrBlocks + 1, 1, false);
+
+		if (nbrBlocks > 0)
+		{
+			Block* pNext{ m_pHead + 1 };
+			SetTags(pNext, m_BufferSize, true);
+			InsertFree(pNext);
+		}
+
+		m_pDefragCursor = m_pHead + 1;
 	}
+
+	m_Stats.Track(this);
 }
 
 template<size_t BLOCKSIZE>
 SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::~DoublyLinkedAllocator()
 {
-	delete[] m_pHead;
+	//relocatable objects are owned by the allocator, the ones still alive are destroyed with it
+	for (const RelocatableEntry& entry : m_Relocatables)
+	{
+		if (entry.pData)
+			entry.pDestroy(entry.pData, entry.count);
+	}
+
+	ReleaseBackingMemory(m_pHead, sizeof(Block) * (m_BufferSize + 2), alignof(Block), m_PageBacking);
 	m_pHead = nullptr;
 }
 
 template<size_t BLOCKSIZE>
 template<typename Typename, typename... Arg_Type>
 Typename* SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Acquire(Arg_Type&&... args)
+{
+	void* pData{ Acquire(sizeof(Typename), alignof(Typename)) };
+	return new (pData) Typename(std::forward<Arg_Type>(args)...);
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename>
+Typename* SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::AcquireArray(size_t count, size_t alignment)
+{
+	void* pData{ Acquire(sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename)) };
+	return ConstructArray<Typename>(pData, count);
+}
+
+template<size_t BLOCKSIZE>
+void* SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Acquire(size_t nbBytes, size_t alignment)
 {
 	SDBX_ASSERT_MSG(m_pHead, "m_pHead is NULL")
+	SDBX_ASSERT_MSG(IsValidAlignment(alignment), "Alignment must be a power of two")
 
-	const auto nbBlocks = (sizeof(Typename) + sizeof(Header) + sizeof(Block) - 1) / sizeof(Block);
+	Block* pCurrent{ AcquireBlock(GetBlockCount(nbBytes, alignment)) };
+	if (!pCurrent)
+		return nullptr;
 
-	Block* pCurrent = m_pHead;
-	while (pCurrent->blockCount < nbBlocks && (pCurrent = pCurrent->link.next) != m_pHead) {
-		Block* pNextBlock = pCurrent + pCurrent->blockCount;
-		if (pNextBlock < (m_pHead + m_BufferSize + 1) && pNextBlock->isFree)
-		{
-			UnLink(*pNextBlock);
-			pNextBlock->isFree = false;
-			pCurrent->blockCount += pNextBlock->blockCount;
+	char* pData{ AlignUp(pCurrent->data, alignment) };
+	if (pData != pCurrent->data)
+	{
+		Header* pPaddingTag{ reinterpret_cast<Header*>(pData) - 1 };
+		pPaddingTag->isFree = true;
+		pPaddingTag->blockCount = size_t(pData - pCurrent->data);
+	}
 
-		}
+	return pData;
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Release(Typename* pData)
+{
+	pData->~Typename();
+	Release(static_cast<void*>(pData));
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::ReleaseArray(Typename* pFirst, size_t count)
+{
+	DestroyArray(pFirst, count);
+	Release(static_cast<void*>(pFirst));
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Release(void* pData)
+{
+	SDBX_ASSERT_MSG(m_pHead, "m_pHead is NULL")
+
+	Block* pBlock{ GetBlock(pData) };
+
+	SDBX_ASSERT(pBlock > m_pHead && pBlock < m_pHead + m_BufferSize + 1)
+	SDBX_ASSERT_MSG(!pBlock->isFree, "Block released twice")
+
+	size_t nbBlocks{ pBlock->blockCount };
+	m_Stats.OnRelease(nbBlocks * sizeof(Block));
+
+	Block* pRightBlock{ pBlock + nbBlocks };
+	if (pRightBlock->isFree)
+	{
+		RemoveFree(pRightBlock);
+		nbBlocks += pRightBlock->blockCount;
+	}
+
+	//the left neighbor footer sits right before our header
+	const Header* pLeftFooter{ reinterpret_cast<Header*>(pBlock) - 1 };
+	if (pLeftFooter->isFree)
+	{
+		Block* pLeftBlock{ pBlock - pLeftFooter->blockCount };
+		RemoveFree(pLeftBlock);
+		nbBlocks += pLeftBlock->blockCount;
+		pBlock = pLeftBlock;
 	}
 
-	SDBX_ASSERT_MSG(pCurrent != m_pHead, "Allocator out of memory")
+	SetTags(pBlock, nbBlocks, true);
+	InsertFree(pBlock);
+
+	//a block merged into its left neighbor doesn't have a valid header anymore
+	if (m_pDefragCursor > pBlock && m_pDefragCursor < pBlock + nbBlocks)
+		m_pDefragCursor = pBlock;
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename, typename... Arg_Type>
+SDBX::Memory::Handle SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::AcquireRelocatable(Arg_Type&&... args)
+{
+	SDBX_STATIC_ASSERT(IsTriviallyRelocatable<Typename>::value || std::is_nothrow_move_constructible_v<Typename>, "Relocatable types must be trivially relocatable or nothrow move constructible");
+
+	const Handle handle{ AddRelocatable(sizeof(Typename), alignof(Typename), 1, &Relocate<Typename>, &Destroy<Typename>, IsTriviallyRelocatable<Typename>::value) };
+	if (IsValid(handle))
+		new (m_Relocatables[handle.index].pData) Typename(std::forward<Arg_Type>(args)...);
+	return handle;
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename>
+SDBX::Memory::Handle SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::AcquireRelocatableArray(size_t count, size_t alignment)
+{
+	SDBX_STATIC_ASSERT(IsTriviallyRelocatable<Typename>::value || std::is_nothrow_move_constructible_v<Typename>, "Relocatable types must be trivially relocatable or nothrow move constructible");
+
+	const Handle handle{ AddRelocatable(sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename), count, &Relocate<Typename>, &Destroy<Typename>, IsTriviallyRelocatable<Typename>::value) };
+	if (IsValid(handle))
+		ConstructArray<Typename>(m_Relocatables[handle.index].pData, count);
+	return handle;
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::ReleaseRelocatable(Handle handle)
+{
+	SDBX_ASSERT_MSG(IsValid(handle), "Releasing a stale handle")
+
+	RelocatableEntry& entry{ m_Relocatables[handle.index] };
+	entry.pDestroy(entry.pData, entry.count);
+	Release(entry.pData);
+	entry.pData = nullptr;
+
+	//never hand out generation 0 again when it wraps
+	entry.generation = entry.generation + 1 != 0 ? entry.generation + 1 : 1;
+	entry.nextFree = m_FreeEntry;
+	m_FreeEntry = handle.index;
+}
+
+template<size_t BLOCKSIZE>
+bool SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Defragment(std::chrono::microseconds budget)
+{
+	SDBX_ASSERT_MSG(m_pHead, "m_pHead is NULL")
 
+	const auto deadline{ std::chrono::steady_clock::now() + budget };
+	do
+	{
+		if (!RelocateNext())
+			return true;
+	} while (std::chrono::steady_clock::now() < deadline);
+
+	return false;
+}
+
+template<size_t BLOCKSIZE>
+typename SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Block* SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::AcquireBlock(size_t nbBlocks)
+{
+	Block* pCurrent{ FindFreeBlock(nbBlocks) };
+
+	SDBX_ASSERT_MSG(pCurrent, "Allocator out of memory")
+	if (!pCurrent)
+		return nullptr;
+
+	//if the free block is larger than the requested number of blocks, split it and put the rest back in its size class
+	RemoveFree(pCurrent);
 	if (pCurrent->blockCount > nbBlocks)
 	{
-		Block* newBlock = pCurrent + nbBlocks;
-		newBlock->blockCount = pCurrent->blockCount - nbBlocks;
-		newBlock->isFree = true;
-		pCurrent->blockCount = nbBlocks;
-		InsertAfter(*pCurrent, *newBlock);
+		Block* pRest{ pCurrent + nbBlocks };
+		SetTags(pRest, pCurrent->blockCount - nbBlocks, true);
+		InsertFree(pRest);
 	}
 
-	UnLink(*pCurrent);
-	pCurrent->isFree = false;
+	SetTags(pCurrent, nbBlocks, false);
+	m_Stats.OnAcquire(nbBlocks * sizeof(Block));
+
+	return pCurrent;
+}
+
+template<size_t BLOCKSIZE>
+char* SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::PlaceRelocatable(Block* pBlock, size_t entryIndex, size_t alignment)
+{
+	reinterpret_cast<RelocationTag*>(pBlock->data)->entryIndex = entryIndex;
 
-	new (pCurrent->data) Typename(std::forward<Arg_Type>(args)...);
+	//the data never directly follows the header, the padding tag is always there for GetBlock
+	char* pData{ AlignUp(pBlock->data + sizeof(RelocationTag), alignment) };
+	Header* pPaddingTag{ reinterpret_cast<Header*>(pData) - 1 };
+	pPaddingTag->isFree = true;
+	pPaddingTag->isRelocatable = false;
+	pPaddingTag->blockCount = size_t(pData - pBlock->data);
 
-	return (Typename*)pCurrent->data;
+	return pData;
 }
 
 template<size_t BLOCKSIZE>
-template<typename Typename>
-void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Release(Typename* pData)
+SDBX::Memory::Handle SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::AddRelocatable(size_t nbBytes, size_t alignment, size_t count, RelocateFnc pRelocate, DestroyFnc pDestroy, bool canOverlap)
 {
 	SDBX_ASSERT_MSG(m_pHead, "m_pHead is NULL")
+	SDBX_ASSERT_MSG(IsValidAlignment(alignment), "Alignment must be a power of two")
 
-	Block* pBlock = reinterpret_cast<Block*>(reinterpret_cast<Header*>(pData) - 1);
+	Block* pBlock{ AcquireBlock(GetBlockCount(sizeof(RelocationTag) + nbBytes, alignment)) };
+	if (!pBlock)
+		return Handle{ NO_SLOT, 0 };
 
-	SDBX_ASSERT(pBlock > m_pHead && pBlock < m_pHead + m_BufferSize + 1)
+	SetTags(pBlock, pBlock->blockCount, false, true);
 
-	pData->~Typename();
-	InsertAfter(*m_pHead, *pBlock);
-	pBlock->isFree = true;
+	if (m_FreeEntry == NO_SLOT)
+	{
+		SDBX_ASSERT_MSG(m_Relocatables.size() < NO_SLOT, "Too many relocatable objects for the handle index")
+
+		//generation starts at 1 so a zeroed handle is never valid
+		m_FreeEntry = uint32_t(m_Relocatables.size());
+		m_Relocatables.push_back(RelocatableEntry{ nullptr, nullptr, nullptr, 0, 0, 0, 1, NO_SLOT, false });
+	}
+
+	const uint32_t entryIndex{ m_FreeEntry };
+	RelocatableEntry& entry{ m_Relocatables[entryIndex] };
+	m_FreeEntry = entry.nextFree;
+
+	entry.pData = PlaceRelocatable(pBlock, entryIndex, alignment);
+	entry.pRelocate = pRelocate;
+	entry.pDestroy = pDestroy;
+	entry.count = count;
+	entry.nbBytes = nbBytes;
+	entry.alignment = alignment;
+	entry.canOverlap = canOverlap;
+
+	return Handle{ entryIndex, entry.generation };
+}
+
+template<size_t BLOCKSIZE>
+bool SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::RelocateNext()
+{
+	Block* pTail{ m_pHead + m_BufferSize + 1 };
+
+	//walk the blocks in address order up to the next free one
+	while (m_pDefragCursor != pTail && !m_pDefragCursor->isFree)
+		m_pDefragCursor += m_pDefragCursor->blockCount;
+
+	Block* pFree{ m_pDefragCursor };
+	Block* pUsed{ pFree != pTail ? pFree + pFree->blockCount : pTail };
+	if (pUsed == pTail)
+	{
+		//only free space left after the cursor, the pass is over
+		m_pDefragCursor = m_pHead + 1;
+		return false;
+	}
+
+	//free blocks are coalesced so the right neighbor is used, blocks acquired by pointer are pinned
+	const size_t usedCount{ pUsed->blockCount };
+	if (!pUsed->isRelocatable)
+	{
+		m_pDefragCursor = pUsed + usedCount;
+		return true;
+	}
+
+	const size_t entryIndex{ reinterpret_cast<RelocationTag*>(pUsed->data)->entryIndex };
+	RelocatableEntry& entry{ m_Relocatables[entryIndex] };
+
+	//a move constructor can't run on overlapping objects, the block waits for a bigger hole in front of it
+	char* pNewData{ AlignUp(pFree->data + sizeof(RelocationTag), entry.alignment) };
+	if (!entry.canOverlap && pNewData + entry.nbBytes > static_cast<char*>(entry.pData))
+	{
+		m_pDefragCursor = pUsed + usedCount;
+		return true;
+	}
+
+	const size_t freeCount{ pFree->blockCount };
+	RemoveFree(pFree);
+
+	//the object is moved before the tags are written, the new footer may land on its old bytes
+	entry.pRelocate(pNewData, entry.pData, entry.count);
+	SetTags(pFree, usedCount, false, true);
+	entry.pData = PlaceRelocatable(pFree, entryIndex, entry.alignment);
+
+	//the hole now follows the moved block, merged with the next block if that one is free too
+	Block* pNewFree{ pFree + usedCount };
+	size_t newFreeCount{ freeCount };
+	Block* pNext{ pNewFree + freeCount };
+	if (pNext->isFree)
+	{
+		RemoveFree(pNext);
+		newFreeCount += pNext->blockCount;
+	}
+
+	SetTags(pNewFree, newFreeCount, true);
+	InsertFree(pNewFree);
+	m_pDefragCursor = pNewFree;
+
+	return true;
 }
 
 template<size_t BLOCKSIZE>
-void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::UnLink(Block& block)
+template<typename Typename>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Relocate(void* pDestination, void* pSource, size_t count)
 {
-	block.link.next->link.prev = block.link.prev;
-	block.link.prev->link.next = block.link.next;
+	if constexpr (IsTriviallyRelocatable<Typename>::value)
+	{
+		std::memmove(pDestination, pSource, sizeof(Typename) * count);
+	}
+	else
+	{
+		Typename* pDst{ static_cast<Typename*>(pDestination) };
+		Typename* pSrc{ static_cast<Typename*>(pSource) };
+		for (size_t idx{}; idx < count; ++idx)
+		{
+			new (pDst + idx) Typename(std::move(pSrc[idx]));
+			pSrc[idx].~Typename();
+		}
+	}
 }
 
 template<size_t BLOCKSIZE>
-void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::InsertAfter(Block& firstBlock, Block& secondBlock)
+size_t SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::GetBlockCount(size_t nbBytes, size_t alignment)
 {
-	secondBlock.link.next = firstBlock.link.next;
-	secondBlock.link.prev = &firstBlock;
-	firstBlock.link.next = &secondBlock;
-	secondBlock.link.next->link.prev = &secondBlock;
-}
\ No newline at end of file
+	const size_t maxPadding{ alignment > alignof(Header) ? alignment - alignof(Header) : 0 };
+
+	//data + padding + header + footer
+	return (nbBytes + maxPadding + sizeof(Header) * 2 + sizeof(Block) - 1) / sizeof(Block);
+}
+
+template<size_t BLOCKSIZE>
+typename SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Block* SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::GetBlock(void* pData) const
+{
+	//the header of a used block is never flagged free, a free flag right before the data means it has been padded for alignment
+	Header* pHeader{ static_cast<Header*>(pData) - 1 };
+	if (pHeader->isFree)
+		pHeader = reinterpret_cast<Header*>(static_cast<char*>(pData) - pHeader->blockCount) - 1;
+
+	return reinterpret_cast<Block*>(pHeader);
+}
+
+template<size_t BLOCKSIZE>
+typename SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::Block* SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::FindFreeBlock(size_t nbBlocks) const
+{
+	//any block in a bin above the request size class is large enough, bin of the size class itself is only guaranteed to fit for power of two requests
+	const uint32_t sizeClass{ GetBin(nbBlocks) };
+	const uint32_t firstFittingBin{ Bit::IsPowerOfTwo(nbBlocks) ? sizeClass : sizeClass + 1 };
+
+	const uint64_t fittingBins{ firstFittingBin < BIN_COUNT ? m_BinMask & (~uint64_t(0) << firstFittingBin) : 0 };
+	if (fittingBins)
+		return m_Bins[Bit::FindFirstSet(fittingBins)];
+
+	//fall back on a first fit search restricted to the size class of the request
+	for (Block* pCurrent{ m_Bins[sizeClass] }; pCurrent; pCurrent = pCurrent->link.next)
+	{
+		if (pCurrent->blockCount >= nbBlocks)
+			return pCurrent;
+	}
+
+	return nullptr;
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::InsertFree(Block* pBlock)
+{
+	//the tags are already written, the block count picks the bin
+	const uint32_t bin{ GetBin(pBlock->blockCount) };
+
+	pBlock->link.prev = nullptr;
+	pBlock->link.next = m_Bins[bin];
+	if (m_Bins[bin])
+		m_Bins[bin]->link.prev = pBlock;
+
+	m_Bins[bin] = pBlock;
+	m_BinMask |= uint64_t(1) << bin;
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::RemoveFree(Block* pBlock)
+{
+	const uint32_t bin{ GetBin(pBlock->blockCount) };
+
+	if (pBlock->link.prev)
+		pBlock->link.prev->link.next = pBlock->link.next;
+	else
+		m_Bins[bin] = pBlock->link.next;
+
+	if (pBlock->link.next)
+		pBlock->link.next->link.prev = pBlock->link.prev;
+
+	if (!m_Bins[bin])
+		m_BinMask &= ~(uint64_t(1) << bin);
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::SetTags(Block* pBlock, size_t blockCount, bool isFree, bool isRelocatable)
+{
+	pBlock->blockCount = blockCount;
+	pBlock->isFree = isFree;
+	pBlock->isRelocatable = isRelocatable;
+
+	Header* pFooter{ GetFooter(pBlock) };
+	pFooter->blockCount = blockCount;
+	pFooter->isFree = isFree;
+	pFooter->isRelocatable = isRelocatable;
+}
+
+template<size_t BLOCKSIZE>
+size_t SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::GetFreeSpaceAmount() const
+{
+	size_t nbFreeBlocks{};
+	for (uint32_t bin{}; bin < BIN_COUNT; ++bin)
+	{
+		for (const Block* pCurrent{ m_Bins[bin] }; pCurrent; pCurrent = pCurrent->link.next)
+			nbFreeBlocks += pCurrent->blockCount;
+	}
+
+	return nbFreeBlocks * sizeof(Block);
+}
+
+template<size_t BLOCKSIZE>
+size_t SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::GetLargestFreeBlock() const
+{
+	if (m_BinMask == 0)
+		return 0;
+
+	//the largest block is in the highest non empty bin
+	size_t largestFreeBlock{};
+	for (const Block* pCurrent{ m_Bins[Bit::FindLastSet(m_BinMask)] }; pCurrent; pCurrent = pCurrent->link.next)
+		largestFreeBlock = std::max<size_t>(largestFreeBlock, pCurrent->blockCount);
+
+	return largestFreeBlock * sizeof(Block);
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+template<size_t BLOCKSIZE>
+void SDBX::Memory::DoublyLinkedAllocator<BLOCKSIZE>::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = m_BufferSize * sizeof(Block);
+	snapshot.freeBytes = GetFreeSpaceAmount();
+	snapshot.largestFreeBlock = GetLargestFreeBlock();
+	snapshot.fragmentation = ComputeFragmentation(snapshot.largestFreeBlock, snapshot.freeBytes);
+}
+#endif
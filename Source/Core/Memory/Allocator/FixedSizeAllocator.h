@@ -1,5 +1,8 @@
 #pragma once
 #include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
 
 namespace SDBX
 {
@@ -50,7 +53,7 @@ namespace SDBX
 				const Typename* m_pElem;
 			};
 
-			explicit FixedSizeAllocator(size_t size);
+			explicit FixedSizeAllocator(size_t size, const PageBacking& pageBacking = PageBacking{});
 			FixedSizeAllocator(const FixedSizeAllocator& other) = delete;
 			FixedSizeAllocator(FixedSizeAllocator&& other) noexcept = delete;
 			FixedSizeAllocator& operator=(const FixedSizeAllocator& other) = delete;
@@ -59,6 +62,7 @@ namespace SDBX
 
 			template<typename... Arg_Type>
 			Typename* Acquire(Arg_Type&&... args);
+			// Moves the last element into the released slot, pointers to it are invalidated, use a HandlePool to keep stable references
 			void Release(Typename*);
 			void Release(iterator it);
 			void Clear();
@@ -71,35 +75,52 @@ namespace SDBX
 			const_iterator cbegin() { return const_iterator{ m_pBegin }; };
 			const_iterator cend() { return const_iterator{ (m_pBegin + m_InUseCount) }; };
 
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
 		private:
 			Typename* m_pBegin;
 			size_t m_BufferSize;
 			size_t m_InUseCount;
+			PageBacking m_PageBacking;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
 		};
 	}
 }
 
+//slots are raw storage, an element only lives between its Acquire and its Release/Clear. Over-aligned Typename get their alignment from the backing memory
 template<typename Typename>
-SDBX::Memory::FixedSizeAllocator<Typename>::FixedSizeAllocator(size_t maxElementCount)
-	: m_pBegin(new Typename[maxElementCount]())
+SDBX::Memory::FixedSizeAllocator<Typename>::FixedSizeAllocator(size_t maxElementCount, const PageBacking& pageBacking)
+	: m_pBegin(nullptr)
 	, m_BufferSize(maxElementCount)
 	, m_InUseCount(0)
-{}
+	, m_PageBacking(pageBacking)
+	, m_Stats("FixedSizeAllocator")
+{
+	void* pMemory{ AcquireBackingMemory(sizeof(Typename) * maxElementCount, alignof(Typename), m_PageBacking) };
+	SDBX_ASSERT_MSG(pMemory != nullptr, "Failed to get the pool memory")
+
+	m_pBegin = static_cast<Typename*>(pMemory);
+	m_Stats.Track(this);
+}
 
 template<typename Typename>
 SDBX::Memory::FixedSizeAllocator<Typename>::~FixedSizeAllocator()
-{ 
+{
 	Clear();
-	delete[] m_pBegin;
+	ReleaseBackingMemory(m_pBegin, sizeof(Typename) * m_BufferSize, alignof(Typename), m_PageBacking);
 }
 
 template<typename Typename>
 void SDBX::Memory::FixedSizeAllocator<Typename>::Clear()
 {
-	for (auto it{ begin() }; it != end(); ++it)
-	{
-		it->~Typename();
-	}
+	DestroyArray(m_pBegin, m_InUseCount);
+	m_Stats.OnRelease(sizeof(Typename) * m_InUseCount, m_InUseCount);
+	m_InUseCount = 0;
 }
 
 template<typename Typename>
@@ -110,6 +131,7 @@ Typename* SDBX::Memory::FixedSizeAllocator<Typename>::Acquire(Arg_Type&&... args
 
 	Typename* acquiredElement{ (m_pBegin + m_InUseCount) };
 	++m_InUseCount;
+	m_Stats.OnAcquire(sizeof(Typename));
 	new (acquiredElement) Typename(std::forward<Arg_Type>(args)...);
 
 	return acquiredElement;
@@ -118,18 +140,32 @@ Typename* SDBX::Memory::FixedSizeAllocator<Typename>::Acquire(Arg_Type&&... args
 template<typename Typename>
 void SDBX::Memory::FixedSizeAllocator<Typename>::Release(Typename* pElement)
 {
-	pElement->~Typename();
+	SDBX_ASSERT_MSG(pElement >= m_pBegin && pElement < m_pBegin + m_InUseCount, "Releasing an element that is not alive in this allocator")
 
-	std::swap(*pElement, *(m_pBegin + m_InUseCount - 1));
+	//keep the elements packed, the last one fills the hole
+	Typename* pLast{ m_pBegin + m_InUseCount - 1 };
+	if (pElement != pLast)
+		*pElement = std::move(*pLast);
+
+	pLast->~Typename();
 	--m_InUseCount;
+	m_Stats.OnRelease(sizeof(Typename));
 }
 
 template<typename Typename>
 void SDBX::Memory::FixedSizeAllocator<Typename>::Release(iterator it)
 {
-	it->~Typename();
-
-	std::swap(*it, *(m_pBegin + m_InUseCount - 1));
-	--m_InUseCount;
+	Release(&*it);
 }
 
+
+#if SDBX_MEMORY_STATS_ENABLED
+template<typename Typename>
+void SDBX::Memory::FixedSizeAllocator<Typename>::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = m_BufferSize * sizeof(Typename);
+	snapshot.freeBytes = (m_BufferSize - m_InUseCount) * sizeof(Typename);
+	snapshot.largestFreeBlock = m_InUseCount < m_BufferSize ? sizeof(Typename) : 0;
+	snapshot.fragmentation = 0.f;
+}
+#endif
@@ -0,0 +1,43 @@
+#include "FrameAllocator.h"
+
+namespace
+{
+	struct ThreadArena
+	{
+		explicit ThreadArena(size_t size, const SDBX::Memory::PageBacking& pageBacking)
+			: buffers{ SDBX::Memory::StackAllocator(size, SDBX::Memory::StackAllocator::Backing::Heap, pageBacking), SDBX::Memory::StackAllocator(size, SDBX::Memory::StackAllocator::Backing::Heap, pageBacking) }
+			, frameIndex{ UINT64_MAX }
+			, pCurrent{ &buffers[0] }
+		{
+			buffers[0].SetStatsInfo("FrameAllocator", SDBX::Memory::MemoryTag::Frame);
+			buffers[1].SetStatsInfo("FrameAllocator", SDBX::Memory::MemoryTag::Frame);
+		}
+
+		SDBX::Memory::StackAllocator buffers[2];
+		uint64_t frameIndex;
+		SDBX::Memory::StackAllocator* pCurrent;
+	};
+}
+
+void SDBX::Memory::FrameAllocator::Init(size_t threadArenaSize, const PageBacking& pageBacking)
+{
+	m_ThreadArenaSize = threadArenaSize;
+	m_PageBacking = pageBacking;
+}
+
+SDBX::Memory::StackAllocator& SDBX::Memory::FrameAllocator::GetThreadAllocator()
+{
+	//created on the first acquire of each thread, released when the thread exits
+	thread_local ThreadArena arena{ m_ThreadArenaSize, m_PageBacking };
+
+	const uint64_t frameIndex{ GetFrameIndex() };
+	if (arena.frameIndex != frameIndex)
+	{
+		//the other stack still holds the previous frame, this one held frame - 2 (or older) and can be recycled
+		arena.frameIndex = frameIndex;
+		arena.pCurrent = &arena.buffers[frameIndex % 2];
+		arena.pCurrent->Reset();
+	}
+
+	return *arena.pCurrent;
+}
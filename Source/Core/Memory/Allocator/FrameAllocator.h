@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Core/Base/Singleton.h"
+#include "Core/Memory/Allocator/StackAllocator.h"
+
+//Per frame scratch memory, FOR POD ONLY like the StackAllocator it is built on.
+//Every thread gets its own pair of stacks, frame N writes in stack N % 2 so its data stays valid while frame N + 1 is built.
+//A stack is reset by its own thread on the first acquire of a new frame, threads never share or lock anything.
+namespace SDBX
+{
+	namespace Memory
+	{
+		class FrameAllocator final : public Singleton<FrameAllocator>
+		{
+		public:
+			static const size_t DEFAULT_THREAD_ARENA_SIZE = 1024 * 1024;
+
+			~FrameAllocator() override = default;
+			FrameAllocator(const FrameAllocator& other) = delete;
+			FrameAllocator(FrameAllocator&& other) noexcept = delete;
+			FrameAllocator& operator=(const FrameAllocator& other) = delete;
+			FrameAllocator& operator=(FrameAllocator&& other) noexcept = delete;
+
+			// Size of each of the two stacks of a thread, must be called before any thread acquires frame memory.
+			// The stacks are created by the thread using them, a firstTouch backing keeps each thread's frame memory on its own NUMA node.
+			void Init(size_t threadArenaSize, const PageBacking& pageBacking = PageBacking{});
+
+			// Frame boundary hook, memory acquired during the frame before the one that just ended becomes invalid
+			void EndFrame() { m_FrameIndex.fetch_add(1, std::memory_order_release); }
+			uint64_t GetFrameIndex() const { return m_FrameIndex.load(std::memory_order_acquire); }
+
+			template<typename Typename, typename... Arg_Type, typename = std::enable_if_t<std::is_trivially_destructible_v<Typename>>>
+			Typename* Acquire(Arg_Type&&... args) { return GetThreadAllocator().Acquire<Typename>(std::forward<Arg_Type>(args)...); }
+
+			template<typename Typename, typename = std::enable_if_t<std::is_trivially_destructible_v<Typename>>>
+			Typename* AcquireArray(size_t count, size_t alignment = alignof(Typename)) { return GetThreadAllocator().AcquireArray<Typename>(count, alignment); }
+
+			void* Acquire(size_t nbBytes, size_t alignment = alignof(std::max_align_t)) { return GetThreadAllocator().Acquire(nbBytes, alignment); }
+
+			// Free memory left in the current frame stack of the calling thread
+			size_t GetFreeSpaceAmount() { return GetThreadAllocator().GetFreeSpaceAmount(); }
+
+		private:
+			friend class Singleton<FrameAllocator>;
+			explicit FrameAllocator() : m_FrameIndex{}, m_ThreadArenaSize{ DEFAULT_THREAD_ARENA_SIZE }, m_PageBacking{} {}
+
+			StackAllocator& GetThreadAllocator();
+
+			std::atomic<uint64_t> m_FrameIndex;
+			size_t m_ThreadArenaSize;
+			PageBacking m_PageBacking;
+		};
+	}
+}
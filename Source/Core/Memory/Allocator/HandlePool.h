@@ -0,0 +1,181 @@
+#pragma once
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/PageBacking.h"
+
+namespace SDBX
+{
+	namespace Memory
+	{
+		//Index into the sparse array + generation of the slot when the handle was given, a released slot bumps its generation so old handles become stale
+		struct Handle
+		{
+			uint32_t index;
+			uint32_t generation;
+
+			bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+			bool operator!=(const Handle& other) const { return !(*this == other); }
+		};
+
+		static const Handle INVALID_HANDLE{ 0, 0 };
+
+		//Objects are packed in a dense array for iteration, handles go through a sparse array that tracks where each object currently lives.
+		//Release moves the last dense object into the hole and patches its sparse slot, outstanding handles stay valid.
+		template<typename Typename>
+		class HandlePool final
+		{
+		public:
+			// pageBacking only applies to the dense object array, the one walked every frame
+			explicit HandlePool(uint32_t capacity, const PageBacking& pageBacking = PageBacking{});
+			HandlePool(const HandlePool& other) = delete;
+			HandlePool(HandlePool&& other) noexcept = delete;
+			HandlePool& operator=(const HandlePool& other) = delete;
+			HandlePool& operator=(HandlePool&& other) noexcept = delete;
+			~HandlePool();
+
+			template<typename... Arg_Type>
+			Handle Acquire(Arg_Type&&... args);
+			void Release(Handle handle);
+			void Clear();
+
+			bool IsValid(Handle handle) const { return handle.index < m_Capacity && handle.generation != 0 && m_pSparse[handle.index].generation == handle.generation; }
+
+			// Returns nullptr for stale handles, the pointer itself is only valid until the next Release
+			Typename* Get(Handle handle) { return IsValid(handle) ? m_pDense + m_pSparse[handle.index].denseIndex : nullptr; }
+			const Typename* Get(Handle handle) const { return IsValid(handle) ? m_pDense + m_pSparse[handle.index].denseIndex : nullptr; }
+
+			// Handle of the object stored at the given position of the dense array
+			Handle GetHandle(size_t denseIndex) const { const uint32_t sparseIndex{ m_pDenseToSparse[denseIndex] }; return Handle{ sparseIndex, m_pSparse[sparseIndex].generation }; }
+
+			size_t Size() const { return m_InUseCount; };
+			size_t Capacity() const { return m_Capacity; };
+
+			Typename* begin() { return m_pDense; };
+			Typename* end() { return m_pDense + m_InUseCount; };
+			const Typename* begin() const { return m_pDense; };
+			const Typename* end() const { return m_pDense + m_InUseCount; };
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
+		private:
+			static const uint32_t NO_SLOT = UINT32_MAX;
+
+			//denseIndex is reused as the next free slot index while the slot is free
+			struct SparseSlot
+			{
+				uint32_t denseIndex;
+				uint32_t generation;
+			};
+
+			Typename* m_pDense;
+			uint32_t* m_pDenseToSparse;
+			SparseSlot* m_pSparse;
+			uint32_t m_Capacity;
+			uint32_t m_InUseCount;
+			uint32_t m_FreeSlot;
+			PageBacking m_PageBacking;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+		};
+	}
+}
+
+template<typename Typename>
+SDBX::Memory::HandlePool<Typename>::HandlePool(uint32_t capacity, const PageBacking& pageBacking)
+	: m_pDense(static_cast<Typename*>(AcquireBackingMemory(sizeof(Typename) * capacity, alignof(Typename), pageBacking)))
+	, m_pDenseToSparse(new uint32_t[capacity])
+	, m_pSparse(new SparseSlot[capacity])
+	, m_Capacity(capacity)
+	, m_InUseCount(0)
+	, m_FreeSlot(capacity > 0 ? 0 : NO_SLOT)
+	, m_PageBacking(pageBacking)
+	, m_Stats("HandlePool")
+{
+	SDBX_ASSERT_MSG(capacity < NO_SLOT, "Capacity doesn't fit the handle index")
+
+	//generation starts at 1 so a zeroed handle is never valid
+	for (uint32_t idx{}; idx < capacity; ++idx)
+		m_pSparse[idx] = SparseSlot{ idx + 1 < capacity ? idx + 1 : NO_SLOT, 1 };
+
+	m_Stats.Track(this);
+}
+
+template<typename Typename>
+SDBX::Memory::HandlePool<Typename>::~HandlePool()
+{
+	Clear();
+	ReleaseBackingMemory(m_pDense, sizeof(Typename) * m_Capacity, alignof(Typename), m_PageBacking);
+	delete[] m_pDenseToSparse;
+	delete[] m_pSparse;
+}
+
+template<typename Typename>
+template<typename... Arg_Type>
+SDBX::Memory::Handle SDBX::Memory::HandlePool<Typename>::Acquire(Arg_Type&&... args)
+{
+	SDBX_ASSERT_MSG(m_FreeSlot != NO_SLOT, "Allocator out of memory")
+
+	const uint32_t sparseIndex{ m_FreeSlot };
+	SparseSlot& slot{ m_pSparse[sparseIndex] };
+	m_FreeSlot = slot.denseIndex;
+
+	new (m_pDense + m_InUseCount) Typename(std::forward<Arg_Type>(args)...);
+	slot.denseIndex = m_InUseCount;
+	m_pDenseToSparse[m_InUseCount] = sparseIndex;
+	++m_InUseCount;
+	m_Stats.OnAcquire(sizeof(Typename));
+
+	return Handle{ sparseIndex, slot.generation };
+}
+
+template<typename Typename>
+void SDBX::Memory::HandlePool<Typename>::Release(Handle handle)
+{
+	SDBX_ASSERT_MSG(IsValid(handle), "Releasing a stale handle")
+
+	SparseSlot& slot{ m_pSparse[handle.index] };
+	const uint32_t lastIndex{ m_InUseCount - 1 };
+
+	//keep the dense array packed, the last object fills the hole and its sparse slot follows it
+	if (slot.denseIndex != lastIndex)
+	{
+		m_pDense[slot.denseIndex] = std::move(m_pDense[lastIndex]);
+		m_pDenseToSparse[slot.denseIndex] = m_pDenseToSparse[lastIndex];
+		m_pSparse[m_pDenseToSparse[lastIndex]].denseIndex = slot.denseIndex;
+	}
+
+	m_pDense[lastIndex].~Typename();
+	--m_InUseCount;
+	m_Stats.OnRelease(sizeof(Typename));
+
+	//never hand out generation 0 again when it wraps
+	slot.generation = slot.generation + 1 != 0 ? slot.generation + 1 : 1;
+	slot.denseIndex = m_FreeSlot;
+	m_FreeSlot = handle.index;
+}
+
+template<typename Typename>
+void SDBX::Memory::HandlePool<Typename>::Clear()
+{
+	while (m_InUseCount > 0)
+		Release(GetHandle(m_InUseCount - 1));
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+template<typename Typename>
+void SDBX::Memory::HandlePool<Typename>::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = size_t(m_Capacity) * sizeof(Typename);
+	snapshot.freeBytes = size_t(m_Capacity - m_InUseCount) * sizeof(Typename);
+	snapshot.largestFreeBlock = m_InUseCount < m_Capacity ? sizeof(Typename) : 0;
+	snapshot.fragmentation = 0.f;
+}
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+#include "Core/Memory/Allocator/DoublyLinkedAllocator.h"
+#include "Core/Memory/Allocator/SinglyLinkedAllocator.h"
+#include "Core/Memory/Allocator/StackAllocator.h"
+
+//std::pmr::memory_resource over an engine allocator so std::pmr containers can be routed into it.
+//The resource only references the allocator, which must outlive every container using it. Like the allocators it is not thread safe.
+namespace SDBX
+{
+	namespace Memory
+	{
+		template<typename Allocator>
+		class MemoryResource final : public std::pmr::memory_resource
+		{
+		public:
+			explicit MemoryResource(Allocator& allocator) : m_Allocator{ allocator } {}
+			MemoryResource(const MemoryResource& other) = delete;
+			MemoryResource(MemoryResource&& other) noexcept = delete;
+			MemoryResource& operator=(const MemoryResource& other) = delete;
+			MemoryResource& operator=(MemoryResource&& other) noexcept = delete;
+			~MemoryResource() override = default;
+
+			Allocator& GetAllocator() const { return m_Allocator; }
+
+		private:
+			Allocator& m_Allocator;
+
+			void* do_allocate(size_t nbBytes, size_t alignment) override
+			{
+				//memory_resource::allocate never returns null, containers rely on it
+				void* pData{ m_Allocator.Acquire(nbBytes, alignment) };
+				if (!pData)
+					throw std::bad_alloc{};
+
+				return pData;
+			}
+
+			void do_deallocate(void* pData, size_t, size_t) override
+			{
+				//a stack can't release in the middle, its memory comes back on Reset/FreeToMarker (same as std::pmr::monotonic_buffer_resource)
+				if constexpr (!std::is_same_v<Allocator, StackAllocator>)
+					m_Allocator.Release(pData);
+			}
+
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+		};
+
+		using StackResource = MemoryResource<StackAllocator>;
+
+		template<size_t BLOCKSIZE = DEFAULT_BLOCKSIZE>
+		using SinglyLinkedResource = MemoryResource<SinglyLinkedAllocator<BLOCKSIZE>>;
+
+		template<size_t BLOCKSIZE = DEFAULT_DL_BLOCKSIZE>
+		using DoublyLinkedResource = MemoryResource<DoublyLinkedAllocator<BLOCKSIZE>>;
+	}
+}
@@ -0,0 +1,414 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/PageBacking.h"
+#include "Core/Misc/Bit/BitUtils.h"
+
+namespace SDBX
+{
+	namespace Memory
+	{
+		static const size_t DEFAULT_PAGE_ELEMENT_COUNT = 256;
+
+		//FixedSizeAllocator growing by pages of PAGE_ELEMENT_COUNT elements, nothing is constructed before Acquire and nothing ever moves:
+		//released slots go to the free list of their page and iteration skips them using the occupancy bits of each page.
+		//Pages with free slots are chained, fully used ones are left out. A page emptied by Release is freed, except one kept as a spare
+		//so an acquire/release pair at a page boundary doesn't allocate every time.
+		template<typename Typename, size_t PAGE_ELEMENT_COUNT = DEFAULT_PAGE_ELEMENT_COUNT>
+		class PagedFixedSizeAllocator final
+		{
+			SDBX_STATIC_ASSERT(PAGE_ELEMENT_COUNT > 0, "A page must hold at least one element");
+
+			union Slot
+			{
+				Slot* pNextFree;
+				alignas(Typename) unsigned char data[sizeof(Typename)];
+			};
+
+			static const size_t MASK_COUNT = (PAGE_ELEMENT_COUNT + 63) / 64;
+
+			struct Page
+			{
+				Slot slots[PAGE_ELEMENT_COUNT];
+				uint64_t usedMask[MASK_COUNT];
+				Slot* pFreeSlot;
+				size_t usedCount;
+				//chain of the pages with free slots
+				Page* pPrevFree;
+				Page* pNextFree;
+
+				bool IsUsed(size_t slotIdx) const { return usedMask[slotIdx / 64] & (uint64_t(1) << (slotIdx % 64)); }
+
+				// First used slot at or after slotIdx, PAGE_ELEMENT_COUNT if none
+				size_t FindUsed(size_t slotIdx) const;
+				// Last used slot at or before slotIdx, PAGE_ELEMENT_COUNT if none
+				size_t FindUsedReverse(size_t slotIdx) const;
+			};
+
+			template<typename PageContainer, typename ValueType>
+			class base_iterator
+			{
+			public:
+				explicit base_iterator(PageContainer* pPages, size_t pageIdx, size_t slotIdx) : m_pPages{ pPages }, m_PageIdx{ pageIdx }, m_SlotIdx{ slotIdx } {};
+
+				ValueType& operator*() const { return *reinterpret_cast<ValueType*>((*m_pPages)[m_PageIdx]->slots[m_SlotIdx].data); }
+				ValueType* operator->() const { return reinterpret_cast<ValueType*>((*m_pPages)[m_PageIdx]->slots[m_SlotIdx].data); }
+
+				base_iterator& operator++() { SkipToUsed(m_SlotIdx + 1); return *this; }
+				base_iterator operator++(int) { const auto temp(*this); ++* this; return temp; }
+				base_iterator& operator--()
+				{
+					size_t pageIdx{ m_PageIdx };
+					size_t slotIdx{ m_SlotIdx };
+					while (pageIdx > 0 || slotIdx > 0)
+					{
+						if (pageIdx < m_pPages->size() && slotIdx > 0 && (*m_pPages)[pageIdx])
+						{
+							const size_t usedIdx{ (*m_pPages)[pageIdx]->FindUsedReverse(slotIdx - 1) };
+							if (usedIdx < PAGE_ELEMENT_COUNT)
+							{
+								m_PageIdx = pageIdx;
+								m_SlotIdx = usedIdx;
+								return *this;
+							}
+						}
+
+						if (pageIdx == 0)
+							break;
+
+						--pageIdx;
+						slotIdx = PAGE_ELEMENT_COUNT;
+					}
+
+					SDBX_ASSERT_MSG(false, "Decrementing begin iterator")
+					return *this;
+				}
+				base_iterator operator--(int) { const auto temp(*this); --* this; return temp; }
+
+				bool operator== (const base_iterator& other) const { return m_PageIdx == other.m_PageIdx && m_SlotIdx == other.m_SlotIdx; }
+				bool operator!= (const base_iterator& other) const { return !(*this == other); }
+
+			private:
+				friend class PagedFixedSizeAllocator;
+
+				PageContainer* m_pPages;
+				size_t m_PageIdx;
+				size_t m_SlotIdx;
+
+				void SkipToUsed(size_t slotIdx)
+				{
+					m_SlotIdx = slotIdx;
+					while (m_PageIdx < m_pPages->size())
+					{
+						//freed pages leave a null entry so indices stay valid
+						m_SlotIdx = m_SlotIdx < PAGE_ELEMENT_COUNT && (*m_pPages)[m_PageIdx] ? (*m_pPages)[m_PageIdx]->FindUsed(m_SlotIdx) : PAGE_ELEMENT_COUNT;
+						if (m_SlotIdx < PAGE_ELEMENT_COUNT)
+							return;
+
+						++m_PageIdx;
+						m_SlotIdx = 0;
+					}
+
+					//reached end()
+					m_SlotIdx = 0;
+				}
+			};
+
+		public:
+			using iterator = base_iterator<std::vector<Page*>, Typename>;
+			using const_iterator = base_iterator<const std::vector<Page*>, const Typename>;
+
+			// Every page is acquired with pageBacking, pick PAGE_ELEMENT_COUNT so a Page fills whole system pages when it isn't the heap
+			explicit PagedFixedSizeAllocator(size_t maxElementCount = SIZE_MAX, const PageBacking& pageBacking = PageBacking{});
+			PagedFixedSizeAllocator(const PagedFixedSizeAllocator& other) = delete;
+			PagedFixedSizeAllocator(PagedFixedSizeAllocator&& other) noexcept = delete;
+			PagedFixedSizeAllocator& operator=(const PagedFixedSizeAllocator& other) = delete;
+			PagedFixedSizeAllocator& operator=(PagedFixedSizeAllocator&& other) noexcept = delete;
+			~PagedFixedSizeAllocator();
+
+			template<typename... Arg_Type>
+			Typename* Acquire(Arg_Type&&... args);
+			void Release(Typename*);
+			void Release(iterator it);
+			void Clear();
+
+			size_t Size() const { return m_InUseCount; };
+			size_t Capacity() const { return m_SortedPages.size() * PAGE_ELEMENT_COUNT; };
+
+			iterator begin() { iterator it{ &m_Pages, 0, 0 }; it.SkipToUsed(0); return it; };
+			iterator end() { return iterator{ &m_Pages, m_Pages.size(), 0 }; };
+			const_iterator cbegin() const { const_iterator it{ &m_Pages, 0, 0 }; it.SkipToUsed(0); return it; };
+			const_iterator cend() const { return const_iterator{ &m_Pages, m_Pages.size(), 0 }; };
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
+		private:
+			//iteration order, a freed page leaves a null entry reused by the next new page so iterators stay valid
+			std::vector<Page*> m_Pages;
+			//page addresses sorted, lets Release find the page of a pointer with a binary search
+			std::vector<Page*> m_SortedPages;
+			Page* m_pFreePage;
+			//empty page kept instead of being freed
+			Page* m_pSparePage;
+			size_t m_MaxElementCount;
+			size_t m_InUseCount;
+			PageBacking m_PageBacking;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+
+			void AddPage();
+			void FreePage(Page* pPage);
+			void LinkFreePage(Page* pPage, bool isAtEnd);
+			void UnlinkFreePage(Page* pPage);
+			Page* FindPage(const Slot* pSlot) const;
+			void ReleaseSlot(Page* pPage, size_t slotIdx);
+		};
+	}
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::PagedFixedSizeAllocator(size_t maxElementCount, const PageBacking& pageBacking)
+	: m_Pages()
+	, m_SortedPages()
+	, m_pFreePage(nullptr)
+	, m_pSparePage(nullptr)
+	, m_MaxElementCount(maxElementCount)
+	, m_InUseCount(0)
+	, m_PageBacking(pageBacking)
+	, m_Stats("PagedFixedSizeAllocator")
+{
+	m_Stats.Track(this);
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::~PagedFixedSizeAllocator()
+{
+	Clear();
+	for (Page* pPage : m_SortedPages)
+		ReleaseBackingMemory(pPage, sizeof(Page), alignof(Page), m_PageBacking);
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+template<typename... Arg_Type>
+Typename* SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::Acquire(Arg_Type&&... args)
+{
+	SDBX_ASSERT_MSG(m_InUseCount < m_MaxElementCount, "Allocator out of memory")
+
+	if (!m_pFreePage)
+		AddPage();
+
+	Page* pPage{ m_pFreePage };
+	Slot* pSlot{ pPage->pFreeSlot };
+	pPage->pFreeSlot = pSlot->pNextFree;
+	if (!pPage->pFreeSlot)
+		UnlinkFreePage(pPage);
+
+	if (pPage == m_pSparePage)
+		m_pSparePage = nullptr;
+
+	const size_t slotIdx{ size_t(pSlot - pPage->slots) };
+	pPage->usedMask[slotIdx / 64] |= uint64_t(1) << (slotIdx % 64);
+	++pPage->usedCount;
+	++m_InUseCount;
+	m_Stats.OnAcquire(sizeof(Slot));
+
+	return new (pSlot->data) Typename(std::forward<Arg_Type>(args)...);
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::Release(Typename* pElement)
+{
+	Slot* pSlot{ reinterpret_cast<Slot*>(pElement) };
+	Page* pPage{ FindPage(pSlot) };
+
+	SDBX_ASSERT_MSG(pPage != nullptr, "Element doesn't belong to this allocator")
+
+	const size_t slotIdx{ size_t(pSlot - pPage->slots) };
+
+	SDBX_ASSERT_MSG(slotIdx < PAGE_ELEMENT_COUNT && pPage->IsUsed(slotIdx), "Element doesn't belong to this allocator")
+
+	ReleaseSlot(pPage, slotIdx);
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::Release(iterator it)
+{
+	ReleaseSlot(m_Pages[it.m_PageIdx], it.m_SlotIdx);
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::Clear()
+{
+	//pages can be freed on the way, walk by index
+	for (size_t pageIdx{}; pageIdx < m_Pages.size(); ++pageIdx)
+	{
+		for (size_t slotIdx{ m_Pages[pageIdx] ? m_Pages[pageIdx]->FindUsed(0) : PAGE_ELEMENT_COUNT }; slotIdx < PAGE_ELEMENT_COUNT; slotIdx = m_Pages[pageIdx] ? m_Pages[pageIdx]->FindUsed(slotIdx + 1) : PAGE_ELEMENT_COUNT)
+			ReleaseSlot(m_Pages[pageIdx], slotIdx);
+	}
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::AddPage()
+{
+	void* pMemory{ AcquireBackingMemory(sizeof(Page), alignof(Page), m_PageBacking) };
+	SDBX_ASSERT_MSG(pMemory != nullptr, "Failed to get a new page")
+
+	Page* pPage{ new (pMemory) Page };
+	std::fill(std::begin(pPage->usedMask), std::end(pPage->usedMask), uint64_t(0));
+	pPage->pFreeSlot = nullptr;
+	pPage->usedCount = 0;
+
+	//link the slots in reverse so the page is filled front to back
+	for (size_t slotIdx{ PAGE_ELEMENT_COUNT }; slotIdx > 0; --slotIdx)
+	{
+		pPage->slots[slotIdx - 1].pNextFree = pPage->pFreeSlot;
+		pPage->pFreeSlot = &pPage->slots[slotIdx - 1];
+	}
+
+	auto holeIt{ std::find(std::begin(m_Pages), std::end(m_Pages), nullptr) };
+	if (holeIt != std::end(m_Pages))
+		*holeIt = pPage;
+	else
+		m_Pages.push_back(pPage);
+
+	m_SortedPages.insert(std::upper_bound(std::begin(m_SortedPages), std::end(m_SortedPages), pPage), pPage);
+	LinkFreePage(pPage, false);
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::FreePage(Page* pPage)
+{
+	*std::find(std::begin(m_Pages), std::end(m_Pages), pPage) = nullptr;
+	m_SortedPages.erase(std::lower_bound(std::begin(m_SortedPages), std::end(m_SortedPages), pPage));
+
+	ReleaseBackingMemory(pPage, sizeof(Page), alignof(Page), m_PageBacking);
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::LinkFreePage(Page* pPage, bool isAtEnd)
+{
+	pPage->pPrevFree = nullptr;
+	pPage->pNextFree = m_pFreePage;
+
+	if (isAtEnd && m_pFreePage)
+	{
+		Page* pLast{ m_pFreePage };
+		while (pLast->pNextFree)
+			pLast = pLast->pNextFree;
+
+		pPage->pPrevFree = pLast;
+		pPage->pNextFree = nullptr;
+		pLast->pNextFree = pPage;
+		return;
+	}
+
+	if (m_pFreePage)
+		m_pFreePage->pPrevFree = pPage;
+	m_pFreePage = pPage;
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::UnlinkFreePage(Page* pPage)
+{
+	if (pPage->pPrevFree)
+		pPage->pPrevFree->pNextFree = pPage->pNextFree;
+	else
+		m_pFreePage = pPage->pNextFree;
+
+	if (pPage->pNextFree)
+		pPage->pNextFree->pPrevFree = pPage->pPrevFree;
+
+	pPage->pPrevFree = nullptr;
+	pPage->pNextFree = nullptr;
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+typename SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::Page* SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::FindPage(const Slot* pSlot) const
+{
+	auto pageIt{ std::upper_bound(std::begin(m_SortedPages), std::end(m_SortedPages), pSlot, [](const Slot* pS, const Page* pP) { return pS < pP->slots; }) };
+	return pageIt != std::begin(m_SortedPages) ? *(pageIt - 1) : nullptr;
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::ReleaseSlot(Page* pPage, size_t slotIdx)
+{
+	Slot& slot{ pPage->slots[slotIdx] };
+	reinterpret_cast<Typename*>(slot.data)->~Typename();
+
+	pPage->usedMask[slotIdx / 64] &= ~(uint64_t(1) << (slotIdx % 64));
+	const bool wasFull{ pPage->pFreeSlot == nullptr };
+	slot.pNextFree = pPage->pFreeSlot;
+	pPage->pFreeSlot = &slot;
+	--pPage->usedCount;
+	--m_InUseCount;
+	m_Stats.OnRelease(sizeof(Slot));
+
+	if (pPage->usedCount == 0)
+	{
+		//a full page isn't in the chain, with one slot per page it goes from full to empty at once
+		if (!wasFull)
+			UnlinkFreePage(pPage);
+
+		if (m_pSparePage && m_pSparePage != pPage)
+		{
+			FreePage(pPage);
+			return;
+		}
+
+		//the spare goes last so partially used pages are filled first
+		LinkFreePage(pPage, true);
+		m_pSparePage = pPage;
+	}
+	else if (wasFull)
+	{
+		LinkFreePage(pPage, false);
+	}
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+size_t SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::Page::FindUsed(size_t slotIdx) const
+{
+	for (size_t maskIdx{ slotIdx / 64 }; maskIdx < MASK_COUNT; ++maskIdx)
+	{
+		const uint64_t mask{ maskIdx == slotIdx / 64 ? usedMask[maskIdx] & (~uint64_t(0) << (slotIdx % 64)) : usedMask[maskIdx] };
+		if (mask)
+			return maskIdx * 64 + Bit::FindFirstSet(mask);
+	}
+
+	return PAGE_ELEMENT_COUNT;
+}
+
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+size_t SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::Page::FindUsedReverse(size_t slotIdx) const
+{
+	for (size_t maskIdx{ slotIdx / 64 + 1 }; maskIdx > 0; --maskIdx)
+	{
+		const size_t shift{ 63 - slotIdx % 64 };
+		const uint64_t mask{ maskIdx - 1 == slotIdx / 64 ? usedMask[maskIdx - 1] & (~uint64_t(0) >> shift) : usedMask[maskIdx - 1] };
+		if (mask)
+			return (maskIdx - 1) * 64 + Bit::FindLastSet(mask);
+	}
+
+	return PAGE_ELEMENT_COUNT;
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+template<typename Typename, size_t PAGE_ELEMENT_COUNT>
+void SDBX::Memory::PagedFixedSizeAllocator<Typename, PAGE_ELEMENT_COUNT>::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = Capacity() * sizeof(Slot);
+	snapshot.freeBytes = (Capacity() - m_InUseCount) * sizeof(Slot);
+	snapshot.largestFreeBlock = m_pFreePage ? sizeof(Slot) : 0;
+	snapshot.fragmentation = 0.f;
+}
+#endif
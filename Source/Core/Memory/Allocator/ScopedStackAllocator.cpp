@@ -0,0 +1,36 @@
+#include "ScopedStackAllocator.h"
+
+SDBX::Memory::ScopedStackAllocator::ScopedStackAllocator(const size_t size, Backing backing, const PageBacking& pageBacking)
+	: m_Stack(size, backing, pageBacking)
+	, m_pLastFinalizer(nullptr)
+{
+	m_Stack.SetStatsInfo("ScopedStackAllocator", MemoryTag::General);
+}
+
+SDBX::Memory::ScopedStackAllocator::~ScopedStackAllocator()
+{
+	RunFinalizers(nullptr);
+}
+
+void SDBX::Memory::ScopedStackAllocator::FreeToMarker(const Marker marker, bool decommit)
+{
+	RunFinalizers(marker);
+	m_Stack.FreeToMarker(marker, decommit);
+}
+
+void SDBX::Memory::ScopedStackAllocator::Reset(bool decommit)
+{
+	RunFinalizers(nullptr);
+	m_Stack.Reset(decommit);
+}
+
+void SDBX::Memory::ScopedStackAllocator::RunFinalizers(const Marker marker)
+{
+	//records are chained from the top of the stack down, everything at or above the marker belongs to the part being freed, no marker runs them all
+	while (m_pLastFinalizer != nullptr && (marker == nullptr || reinterpret_cast<char*>(m_pLastFinalizer) >= marker))
+	{
+		Finalizer* pFinalizer{ m_pLastFinalizer };
+		m_pLastFinalizer = pFinalizer->pPrevious;
+		pFinalizer->pDestroy(pFinalizer->pObject, pFinalizer->count);
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "Core/Memory/Allocator/StackAllocator.h"
+
+//StackAllocator that also takes non POD objects.
+//Every object that needs a destructor gets a small finalizer record written in the arena right before it, the records are chained from the top of the stack down.
+//FreeToMarker and Reset walk that chain and destroy the objects above the marker in reverse acquire order, trivially destructible types cost nothing extra.
+namespace SDBX
+{
+	namespace Memory
+	{
+		class ScopedStackAllocator final
+		{
+		public:
+			using Backing = StackAllocator::Backing;
+			using Marker = StackAllocator::Marker;
+
+			explicit ScopedStackAllocator(size_t size, Backing backing = Backing::Heap, const PageBacking& pageBacking = PageBacking{});
+			~ScopedStackAllocator();
+			ScopedStackAllocator(const ScopedStackAllocator& other) = delete;
+			ScopedStackAllocator(ScopedStackAllocator&& other) noexcept = delete;
+			ScopedStackAllocator& operator=(const ScopedStackAllocator& other) = delete;
+			ScopedStackAllocator& operator=(ScopedStackAllocator&& other) noexcept = delete;
+
+			// Get a marker to the current top of the stack.
+			inline Marker GetMarker() const { return m_Stack.GetMarker(); }
+
+			// Destroy every object acquired after the marker, newest first, then free the memory up to it
+			void FreeToMarker(Marker marker, bool decommit = false);
+
+			template<typename Typename, typename... Arg_Type>
+			Typename* Acquire(Arg_Type&&... args);
+
+			// Default construct count contiguous elements, they are destroyed together in reverse order
+			template<typename Typename>
+			Typename* AcquireArray(size_t count, size_t alignment = alignof(Typename));
+
+			// Acquire raw memory, nothing is run on it when the stack unwinds
+			void* Acquire(size_t nbBytes, size_t alignment = 1) { return m_Stack.Acquire(nbBytes, alignment); }
+
+			// Destroy every object still alive and reset the complete stack
+			void Reset(bool decommit = false);
+
+			// Get the amount of free memory that is left on the stack.
+			inline size_t GetFreeSpaceAmount() const { return m_Stack.GetFreeSpaceAmount(); }
+			inline size_t GetCommittedAmount() const { return m_Stack.GetCommittedAmount(); }
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stack.SetStatsInfo(name, tag); }
+
+		private:
+			//destroys count objects starting at pObject, pPrevious is the finalizer of the object acquired before this one
+			struct Finalizer
+			{
+				void (*pDestroy)(void* pObject, size_t count);
+				Finalizer* pPrevious;
+				size_t count;
+				void* pObject;
+			};
+
+			template<typename Typename>
+			static void Destroy(void* pObject, size_t count) { DestroyArray(static_cast<Typename*>(pObject), count); }
+
+			//nullptr runs the whole chain
+			void RunFinalizers(Marker marker);
+
+			StackAllocator m_Stack;
+			Finalizer* m_pLastFinalizer;
+		};
+
+		// Frees its allocator back to the marker taken on construction when it goes out of scope.
+		// Works with both StackAllocator and ScopedStackAllocator, the latter also destroys the objects acquired inside the scope.
+		template<typename Allocator>
+		class StackScope final
+		{
+		public:
+			explicit StackScope(Allocator& allocator) : m_Allocator{ allocator }, m_Marker{ allocator.GetMarker() } {}
+			~StackScope() { m_Allocator.FreeToMarker(m_Marker); }
+			StackScope(const StackScope& other) = delete;
+			StackScope(StackScope&& other) noexcept = delete;
+			StackScope& operator=(const StackScope& other) = delete;
+			StackScope& operator=(StackScope&& other) noexcept = delete;
+
+		private:
+			Allocator& m_Allocator;
+			typename Allocator::Marker m_Marker;
+		};
+	}
+}
+
+template<typename Typename, typename... Arg_Type>
+Typename* SDBX::Memory::ScopedStackAllocator::Acquire(Arg_Type&&... args)
+{
+	if constexpr (std::is_trivially_destructible_v<Typename>)
+	{
+		return m_Stack.Acquire<Typename>(std::forward<Arg_Type>(args)...);
+	}
+	else
+	{
+		//the record is written below the object so it is freed together with it, it is only linked once construction succeeded
+		Finalizer* pFinalizer{ static_cast<Finalizer*>(m_Stack.Acquire(sizeof(Finalizer), alignof(Finalizer))) };
+		Typename* pObject{ new (m_Stack.Acquire(sizeof(Typename), alignof(Typename))) Typename(std::forward<Arg_Type>(args)...) };
+
+		*pFinalizer = Finalizer{ &Destroy<Typename>, m_pLastFinalizer, 1, pObject };
+		m_pLastFinalizer = pFinalizer;
+		return pObject;
+	}
+}
+
+template<typename Typename>
+Typename* SDBX::Memory::ScopedStackAllocator::AcquireArray(size_t count, size_t alignment)
+{
+	if constexpr (std::is_trivially_destructible_v<Typename>)
+	{
+		return m_Stack.AcquireArray<Typename>(count, alignment);
+	}
+	else
+	{
+		Finalizer* pFinalizer{ static_cast<Finalizer*>(m_Stack.Acquire(sizeof(Finalizer), alignof(Finalizer))) };
+		void* acquiredMemory{ m_Stack.Acquire(sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename)) };
+		Typename* pFirst{ ConstructArray<Typename>(acquiredMemory, count) };
+
+		*pFinalizer = Finalizer{ &Destroy<Typename>, m_pLastFinalizer, count, pFirst };
+		m_pLastFinalizer = pFinalizer;
+		return pFirst;
+	}
+}
@@ -1,5 +1,12 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
+
 #include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
+#include "Core/Misc/Bit/BitUtils.h"
 
 namespace SDBX
 {
@@ -7,21 +14,42 @@ namespace SDBX
 	{
 		static const size_t DEFAULT_BLOCKSIZE = 16;
 
+		//Segregated fit allocator: free blocks are sorted in power of two size classes (bin i holds blocks of [2^i, 2^(i+1)[ blocks),
+		//a bitmap keeps track of the non empty bins so a fitting bin is found with a single bit scan.
+		//Free blocks carry a footer and their right neighbor a "previous is free" flag so Release can coalesce with both neighbors without searching.
+		//Over-aligned data is pushed forward inside its block, the word right before it is then a padding tag (isFree set) holding the distance to the header.
 		template<size_t BLOCKSIZE = DEFAULT_BLOCKSIZE>
 		class SinglyLinkedAllocator final
 		{
 		public:
+			using BlockIndex = uint32_t;
+
+			struct Header
+			{
+				size_t isFree : 1;
+				size_t isPrevFree : 1;
+				size_t blockCount : sizeof(size_t) * 8 - 2;
+			};
 
-			struct Block
+			struct Block : Header
 			{
-				size_t blockCount;
-				union {
-					Block* pNext;
-					char data[BLOCKSIZE - sizeof(blockCount)];
+				//links are stored as block indices so both of them fit in the smallest block, index 0 (head block) is used as null
+				struct Links
+				{
+					BlockIndex next;
+					BlockIndex prev;
+				};
+				union
+				{
+					Links link;
+					char data[BLOCKSIZE - sizeof(Header)];
 				};
 			};
 
-			explicit SinglyLinkedAllocator(size_t nbBlocks);
+			SDBX_STATIC_ASSERT(BLOCKSIZE >= sizeof(Header) + sizeof(typename Block::Links), "BLOCKSIZE is too small to store a free block");
+			SDBX_STATIC_ASSERT(BLOCKSIZE % alignof(Header) == 0, "BLOCKSIZE must be a multiple of the header alignment");
+
+			explicit SinglyLinkedAllocator(size_t nbBlocks, const PageBacking& pageBacking = PageBacking{});
 			SinglyLinkedAllocator(const SinglyLinkedAllocator& other) = delete;
 			SinglyLinkedAllocator(SinglyLinkedAllocator&& other) noexcept = delete;
 			SinglyLinkedAllocator& operator=(const SinglyLinkedAllocator& other) = delete;
@@ -31,115 +59,311 @@ namespace SDBX
 			template<typename Typename, typename... Arg_Type>
 			Typename* Acquire(Arg_Type&&... args);
 
+			// Default construct count contiguous elements, alignment can be raised above alignof(Typename)
+			template<typename Typename>
+			Typename* AcquireArray(size_t count, size_t alignment = alignof(Typename));
+
+			void* Acquire(size_t nbBytes, size_t alignment = alignof(Header));
+
 			template<typename Typename>
 			void Release(Typename* pData);
 
+			template<typename Typename>
+			void ReleaseArray(Typename* pFirst, size_t count);
+
+			void Release(void* pData);
+
+			// Free bytes and size of the largest free block, both walk the free lists
+			size_t GetFreeSpaceAmount() const;
+			size_t GetLargestFreeBlock() const;
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
 		private:
+			static const uint32_t BIN_COUNT = sizeof(size_t) * 8;
+
 			Block* m_pHead;
 			size_t m_BufferSize;
+			uint64_t m_BinMask;
+			BlockIndex m_Bins[BIN_COUNT];
+			PageBacking m_PageBacking;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+
+			Block* GetBlock(void* pData) const;
+			Block* FindFreeBlock(size_t nbBlocks) const;
+			void InsertFree(Block* pBlock, size_t nbBlocks);
+			void RemoveFree(Block* pBlock);
+
+			inline BlockIndex ToIndex(const Block* pBlock) const { return static_cast<BlockIndex>(pBlock - m_pHead); }
+			inline Block* ToBlock(BlockIndex idx) const { return m_pHead + idx; }
+			inline static uint32_t GetBin(size_t nbBlocks) { return Bit::FindLastSet(nbBlocks); }
 		};
 	}
 }
 
 template<size_t BLOCKSIZE>
-SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::SinglyLinkedAllocator(size_t nbBlocks)
+SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::SinglyLinkedAllocator(size_t nbBlocks, const PageBacking& pageBacking)
 	: m_pHead(nullptr)
 	, m_BufferSize()
+	, m_BinMask()
+	, m_Bins()
+	, m_PageBacking(pageBacking)
+	, m_Stats("SinglyLinkedAllocator")
 {
-	//adjust memory block to allocate if it doesn't respect memory alignment
+	SDBX_ASSERT_MSG(nbBlocks > 0 && nbBlocks + 2 <= UINT32_MAX, "Block count doesn't fit the block index")
+
 	m_BufferSize = nbBlocks;
 
-	//allocate one extra block for the head
-	m_pHead = new Block[nbBlocks + 1];
+	//allocate one extra block for the head and one for the tail, they are never free so the neighbor checks don't need bounds checks
+	m_pHead = static_cast<Block*>(AcquireBackingMemory(sizeof(Block) * (nbBlocks + 2), alignof(Block), m_PageBacking));
 
 	if (m_pHead)
 	{
-		m_pHead->blockCount = 0;
-		Block* pNext{ m_pHead + 1 };
-		pNext->blockCount = nbBlocks;
-		pNext->pNext = nullptr;
-		m_pHead->pNext = pNext;
+		m_pHead->blockCount = 1;
+		m_pHead->isFree = false;
+		m_pHead->isPrevFree = false;
+
+		Block* pTail{ m_pHead + nbBlocks + 1 };
+		pTail->blockCount = 1;
+		pTail->isFree = false;
+		pTail->isPrevFree = false;
+
+		Block* pFirst{ m_pHead + 1 };
+		pFirst->isPrevFree = false;
+		InsertFree(pFirst, nbBlocks);
 	}
+
+	m_Stats.Track(this);
 }
 
 template<size_t BLOCKSIZE>
 SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::~SinglyLinkedAllocator()
 {
-	delete[] m_pHead;
+	ReleaseBackingMemory(m_pHead, sizeof(Block) * (m_BufferSize + 2), alignof(Block), m_PageBacking);
 	m_pHead = nullptr;
 }
 
 template<size_t BLOCKSIZE>
 template<typename Typename, typename... Arg_Type>
 Typename* SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::Acquire(Arg_Type&&... args)
+{
+	void* pData{ Acquire(sizeof(Typename), alignof(Typename)) };
+
+	//call Typename constructor, buffer overrun warning can be ignored because, if it happens, we already "reserved" the blocks that will be overwritten
+	return new (pData) Typename(std::forward<Arg_Type>(args)...);
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename>
+Typename* SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::AcquireArray(size_t count, size_t alignment)
+{
+	void* pData{ Acquire(sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename)) };
+	return ConstructArray<Typename>(pData, count);
+}
+
+template<size_t BLOCKSIZE>
+void* SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::Acquire(size_t nbBytes, size_t alignment)
 {
 	SDBX_ASSERT_MSG(m_pHead, "m_pHead is NULL")
+	SDBX_ASSERT_MSG(IsValidAlignment(alignment), "Alignment must be a power of two")
 
-	//calculate the number of blocks required to store the Typename object (requires extra space to store the block count) 
-	const auto nbBlocks = (sizeof(Typename) + sizeof(Block::blockCount) + BLOCKSIZE - 1) / BLOCKSIZE;
+	//data right after the header is always aligned on the header alignment, anything above that may need up to (alignment - alignof(Header)) bytes of padding
+	const size_t maxPadding{ alignment > alignof(Header) ? alignment - alignof(Header) : 0 };
 
-	Block* pPreviousBlock = m_pHead;
-	Block* pNextBlock = m_pHead->pNext;
-	while (pNextBlock != nullptr && pNextBlock->blockCount < nbBlocks) {
-		pPreviousBlock = pNextBlock;
-		pNextBlock = pNextBlock->pNext;
-	}
+	//calculate the number of blocks required to store the data (requires extra space to store the header)
+	const size_t nbBlocks = (nbBytes + maxPadding + sizeof(Header) + BLOCKSIZE - 1) / BLOCKSIZE;
 
-	//Reached end of the buffer without finding enough space
-	SDBX_ASSERT_MSG(pNextBlock, "Allocator out of memory")
+	Block* pBlock{ FindFreeBlock(nbBlocks) };
 
-	//if the free block is larger than the requested number of blocks, need to split the free block to only acquire the minimum requested number of block and create a free block with the rest
-	if (pNextBlock->blockCount > nbBlocks)
+	SDBX_ASSERT_MSG(pBlock, "Allocator out of memory")
+	if (!pBlock)
+		return nullptr;
+
+	RemoveFree(pBlock);
+
+	//if the free block is larger than the requested number of blocks, split it and put the rest back in its size class
+	const size_t freeCount{ pBlock->blockCount };
+	if (freeCount > nbBlocks)
 	{
-		Block* newBlock = pNextBlock + nbBlocks;
-		newBlock->blockCount = pNextBlock->blockCount - nbBlocks;
-		newBlock->pNext = pNextBlock->pNext;
-		pNextBlock->blockCount = nbBlocks;
-		pNextBlock->pNext = newBlock;
+		(pBlock + nbBlocks)->isPrevFree = false;
+		InsertFree(pBlock + nbBlocks, freeCount - nbBlocks);
 	}
 
-	pPreviousBlock->pNext = pNextBlock->pNext;
+	pBlock->blockCount = nbBlocks;
+	pBlock->isFree = false;
+	m_Stats.OnAcquire(nbBlocks * BLOCKSIZE);
 
-	//call Typename default constructor, buffer overrun warning can be ignored because, if it happens, we already "reserved" the blocks that will be overwritten
-	new (pNextBlock->data) Typename(std::forward<Arg_Type>(args)...);
+	char* pData{ AlignUp(pBlock->data, alignment) };
+	if (pData != pBlock->data)
+	{
+		Header* pPaddingTag{ reinterpret_cast<Header*>(pData) - 1 };
+		pPaddingTag->isFree = true;
+		pPaddingTag->blockCount = size_t(pData - pBlock->data);
+	}
 
-	return (Typename*)pNextBlock->data;
+	return pData;
 }
 
 template<size_t BLOCKSIZE>
 template<typename Typename>
 void SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::Release(Typename* pData)
+{
+	pData->~Typename();
+	Release(static_cast<void*>(pData));
+}
+
+template<size_t BLOCKSIZE>
+template<typename Typename>
+void SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::ReleaseArray(Typename* pFirst, size_t count)
+{
+	DestroyArray(pFirst, count);
+	Release(static_cast<void*>(pFirst));
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::Release(void* pData)
 {
 	SDBX_ASSERT_MSG(m_pHead, "m_pHead is NULL")
 
-	Block* pBlock = reinterpret_cast<Block*>(reinterpret_cast<char*>(pData) - sizeof(Block::blockCount));
+	Block* pBlock{ GetBlock(pData) };
 
 	SDBX_ASSERT(pBlock > m_pHead && pBlock < m_pHead + m_BufferSize + 1)
+	SDBX_ASSERT_MSG(!pBlock->isFree, "Block released twice")
 
-	Block* pFreeBlock{ m_pHead };
-	while (pFreeBlock->pNext != nullptr && pFreeBlock->pNext < pBlock)
+	size_t nbBlocks{ pBlock->blockCount };
+	m_Stats.OnRelease(nbBlocks * BLOCKSIZE);
+
+	Block* pBlockNeighbor{ pBlock + nbBlocks };
+	if (pBlockNeighbor->isFree) //check if the right adjacent block is free, merge it with the current block if it is
 	{
-		pFreeBlock = pFreeBlock->pNext;
+		RemoveFree(pBlockNeighbor);
+		nbBlocks += pBlockNeighbor->blockCount;
 	}
 
-	pData->~Typename();
-	pBlock->pNext = pFreeBlock->pNext;
-	pFreeBlock->pNext = pBlock;
+	if (pBlock->isPrevFree) //check if the left adjacent block is free, its footer gives us its size
+	{
+		Block* pPrevBlock{ pBlock - (pBlock - 1)->blockCount };
+		RemoveFree(pPrevBlock);
+		nbBlocks += pPrevBlock->blockCount;
+		pBlock = pPrevBlock;
+	}
+
+	InsertFree(pBlock, nbBlocks);
+}
 
-	Block* pBlockNeighbor{ pBlock + pBlock->blockCount };
-	if (pBlock->pNext == pBlockNeighbor) //check if the right adjacent block are free, merge it with the current node if it is
+template<size_t BLOCKSIZE>
+typename SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::Block* SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::GetBlock(void* pData) const
+{
+	//the header of a used block is never flagged free, a free flag right before the data means it has been padded for alignment
+	Header* pHeader{ static_cast<Header*>(pData) - 1 };
+	if (pHeader->isFree)
+		pHeader = reinterpret_cast<Header*>(static_cast<char*>(pData) - pHeader->blockCount) - 1;
+
+	return reinterpret_cast<Block*>(pHeader);
+}
+
+template<size_t BLOCKSIZE>
+typename SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::Block* SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::FindFreeBlock(size_t nbBlocks) const
+{
+	//any block in a bin above the request size class is large enough, bin of the size class itself is only guaranteed to fit for power of two requests
+	const uint32_t sizeClass{ GetBin(nbBlocks) };
+	const uint32_t firstFittingBin{ Bit::IsPowerOfTwo(nbBlocks) ? sizeClass : sizeClass + 1 };
+
+	const uint64_t fittingBins{ firstFittingBin < BIN_COUNT ? m_BinMask & (~uint64_t(0) << firstFittingBin) : 0 };
+	if (fittingBins)
+		return ToBlock(m_Bins[Bit::FindFirstSet(fittingBins)]);
+
+	//fall back on a first fit search restricted to the size class of the request
+	for (BlockIndex idx{ m_Bins[sizeClass] }; idx != 0; idx = ToBlock(idx)->link.next)
 	{
-		pBlock->blockCount += pBlockNeighbor->blockCount;
-		pBlock->pNext = pBlockNeighbor->pNext;
+		if (ToBlock(idx)->blockCount >= nbBlocks)
+			return ToBlock(idx);
 	}
 
-	if (pFreeBlock == m_pHead)
-		return;
+	return nullptr;
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::InsertFree(Block* pBlock, size_t nbBlocks)
+{
+	pBlock->blockCount = nbBlocks;
+	pBlock->isFree = true;
+
+	//footer, lets the right neighbor find the start of this block
+	(pBlock + nbBlocks - 1)->blockCount = nbBlocks;
+	(pBlock + nbBlocks)->isPrevFree = true;
+
+	const uint32_t bin{ GetBin(nbBlocks) };
+	const BlockIndex idx{ ToIndex(pBlock) };
+
+	pBlock->link.prev = 0;
+	pBlock->link.next = m_Bins[bin];
+	if (m_Bins[bin] != 0)
+		ToBlock(m_Bins[bin])->link.prev = idx;
+
+	m_Bins[bin] = idx;
+	m_BinMask |= uint64_t(1) << bin;
+}
+
+template<size_t BLOCKSIZE>
+void SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::RemoveFree(Block* pBlock)
+{
+	const uint32_t bin{ GetBin(pBlock->blockCount) };
+
+	if (pBlock->link.prev != 0)
+		ToBlock(pBlock->link.prev)->link.next = pBlock->link.next;
+	else
+		m_Bins[bin] = pBlock->link.next;
+
+	if (pBlock->link.next != 0)
+		ToBlock(pBlock->link.next)->link.prev = pBlock->link.prev;
 
-	Block* pFreeBlockNeighbor{ pFreeBlock + pFreeBlock->blockCount };
-	if (pBlock == pFreeBlockNeighbor)  //check if the current block being released is the right neighbor of the previous free block, merge them if it is
+	if (m_Bins[bin] == 0)
+		m_BinMask &= ~(uint64_t(1) << bin);
+
+	pBlock->isFree = false;
+	(pBlock + pBlock->blockCount)->isPrevFree = false;
+}
+
+template<size_t BLOCKSIZE>
+size_t SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::GetFreeSpaceAmount() const
+{
+	size_t nbFreeBlocks{};
+	for (uint32_t bin{}; bin < BIN_COUNT; ++bin)
 	{
-		pFreeBlock->blockCount += pBlock->blockCount;
-		pFreeBlock->pNext = pBlock->pNext;
+		for (BlockIndex idx{ m_Bins[bin] }; idx != 0; idx = ToBlock(idx)->link.next)
+			nbFreeBlocks += ToBlock(idx)->blockCount;
 	}
-}
\ No newline at end of file
+
+	return nbFreeBlocks * BLOCKSIZE;
+}
+
+template<size_t BLOCKSIZE>
+size_t SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::GetLargestFreeBlock() const
+{
+	if (m_BinMask == 0)
+		return 0;
+
+	//the largest block is in the highest non empty bin
+	size_t largestFreeBlock{};
+	for (BlockIndex idx{ m_Bins[Bit::FindLastSet(m_BinMask)] }; idx != 0; idx = ToBlock(idx)->link.next)
+		largestFreeBlock = std::max<size_t>(largestFreeBlock, ToBlock(idx)->blockCount);
+
+	return largestFreeBlock * BLOCKSIZE;
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+template<size_t BLOCKSIZE>
+void SDBX::Memory::SinglyLinkedAllocator<BLOCKSIZE>::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = m_BufferSize * BLOCKSIZE;
+	snapshot.freeBytes = GetFreeSpaceAmount();
+	snapshot.largestFreeBlock = GetLargestFreeBlock();
+	snapshot.fragmentation = ComputeFragmentation(snapshot.largestFreeBlock, snapshot.freeBytes);
+}
+#endif
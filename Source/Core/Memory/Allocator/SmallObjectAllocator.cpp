@@ -0,0 +1,181 @@
+#include "SmallObjectAllocator.h"
+
+#include <algorithm>
+
+SDBX::Memory::SmallObjectAllocator::SmallObjectAllocator(const PageBacking& pageBacking)
+	: m_SizeClasses()
+	, m_Chunks()
+	, m_pLargeObjects(nullptr)
+	, m_PageBacking(pageBacking)
+	, m_Stats("SmallObjectAllocator")
+{
+	m_Stats.Track(this);
+}
+
+SDBX::Memory::SmallObjectAllocator::~SmallObjectAllocator()
+{
+	for (const Chunk& chunk : m_Chunks)
+		ReleaseBackingMemory(chunk.pBegin, CHUNK_SIZE, SIZE_CLASS_GRANULARITY, m_PageBacking);
+
+	while (m_pLargeObjects)
+	{
+		LargeHeader* pHeader{ m_pLargeObjects };
+		m_pLargeObjects = pHeader->pNext;
+
+		const size_t offset{ GetLargeOffset(pHeader->alignment) };
+		::operator delete(reinterpret_cast<char*>(pHeader + 1) - offset, std::align_val_t{ pHeader->alignment });
+	}
+}
+
+void* SDBX::Memory::SmallObjectAllocator::Acquire(size_t nbBytes, size_t alignment)
+{
+	SDBX_ASSERT_MSG(IsValidAlignment(alignment), "Alignment must be a power of two")
+
+	//slots are only aligned on the granularity, stricter requests go to the heap
+	if (nbBytes > MAX_SMALL_SIZE || alignment > SIZE_CLASS_GRANULARITY)
+		return AcquireLarge(nbBytes, alignment);
+
+	const uint32_t sizeClassIdx{ GetSizeClass(nbBytes > 0 ? nbBytes : 1) };
+	const size_t slotSize{ GetSlotSize(sizeClassIdx) };
+	SizeClass& sizeClass{ m_SizeClasses[sizeClassIdx] };
+
+	m_Stats.OnAcquire(slotSize);
+
+	if (sizeClass.freeSlotCount == 0)
+		AddChunk(sizeClassIdx);
+
+	--sizeClass.freeSlotCount;
+	if (sizeClass.pFreeSlot)
+	{
+		FreeSlot* pSlot{ sizeClass.pFreeSlot };
+		sizeClass.pFreeSlot = pSlot->pNext;
+		return pSlot;
+	}
+
+	void* pSlot{ sizeClass.pBump };
+	sizeClass.pBump += slotSize;
+	return pSlot;
+}
+
+void SDBX::Memory::SmallObjectAllocator::Release(void* pData)
+{
+	if (!pData)
+		return;
+
+	const Chunk* pChunk{ FindChunk(pData) };
+	if (!pChunk)
+	{
+		ReleaseLarge(pData);
+		return;
+	}
+
+	const size_t slotSize{ GetSlotSize(pChunk->sizeClass) };
+	SizeClass& sizeClass{ m_SizeClasses[pChunk->sizeClass] };
+
+	FreeSlot* pSlot{ static_cast<FreeSlot*>(pData) };
+	pSlot->pNext = sizeClass.pFreeSlot;
+	sizeClass.pFreeSlot = pSlot;
+	++sizeClass.freeSlotCount;
+
+	m_Stats.OnRelease(slotSize);
+}
+
+void SDBX::Memory::SmallObjectAllocator::AddChunk(uint32_t sizeClassIdx)
+{
+	char* pBegin{ static_cast<char*>(AcquireBackingMemory(CHUNK_SIZE, SIZE_CLASS_GRANULARITY, m_PageBacking)) };
+	SDBX_ASSERT_MSG(pBegin != nullptr, "Failed to get a new chunk")
+
+	const Chunk chunk{ pBegin, sizeClassIdx };
+	m_Chunks.insert(std::upper_bound(std::begin(m_Chunks), std::end(m_Chunks), chunk, [](const Chunk& lhs, const Chunk& rhs) { return lhs.pBegin < rhs.pBegin; }), chunk);
+
+	//slots never straddle two chunks, the tail too small for a whole slot stays unused
+	SizeClass& sizeClass{ m_SizeClasses[sizeClassIdx] };
+	const size_t slotSize{ GetSlotSize(sizeClassIdx) };
+	sizeClass.pBump = pBegin;
+	sizeClass.pBumpEnd = pBegin + (CHUNK_SIZE / slotSize) * slotSize;
+	sizeClass.freeSlotCount += CHUNK_SIZE / slotSize;
+}
+
+size_t SDBX::Memory::SmallObjectAllocator::GetFreeSpaceAmount() const
+{
+	size_t freeSpace{};
+	for (uint32_t sizeClassIdx{}; sizeClassIdx < SIZE_CLASS_COUNT; ++sizeClassIdx)
+		freeSpace += m_SizeClasses[sizeClassIdx].freeSlotCount * GetSlotSize(sizeClassIdx);
+
+	return freeSpace;
+}
+
+size_t SDBX::Memory::SmallObjectAllocator::GetLargestFreeBlock() const
+{
+	for (uint32_t sizeClassIdx{ SIZE_CLASS_COUNT }; sizeClassIdx > 0; --sizeClassIdx)
+	{
+		if (m_SizeClasses[sizeClassIdx - 1].freeSlotCount > 0)
+			return GetSlotSize(sizeClassIdx - 1);
+	}
+
+	return 0;
+}
+
+size_t SDBX::Memory::SmallObjectAllocator::GetFreeSlotCount(size_t nbBytes) const
+{
+	if (nbBytes > MAX_SMALL_SIZE)
+		return 0;
+
+	return m_SizeClasses[GetSizeClass(nbBytes > 0 ? nbBytes : 1)].freeSlotCount;
+}
+
+const SDBX::Memory::SmallObjectAllocator::Chunk* SDBX::Memory::SmallObjectAllocator::FindChunk(const void* pData) const
+{
+	const char* pAddress{ static_cast<const char*>(pData) };
+	auto chunkIt{ std::upper_bound(std::cbegin(m_Chunks), std::cend(m_Chunks), pAddress, [](const char* pA, const Chunk& chunk) { return pA < chunk.pBegin; }) };
+	if (chunkIt == std::cbegin(m_Chunks))
+		return nullptr;
+
+	--chunkIt;
+	return pAddress < chunkIt->pBegin + CHUNK_SIZE ? &*chunkIt : nullptr;
+}
+
+void* SDBX::Memory::SmallObjectAllocator::AcquireLarge(size_t nbBytes, size_t alignment)
+{
+	if (alignment < alignof(LargeHeader))
+		alignment = alignof(LargeHeader);
+
+	//the header sits right before the object, the offset keeps the object on its alignment
+	const size_t offset{ GetLargeOffset(alignment) };
+	char* pMemory{ static_cast<char*>(::operator new(offset + nbBytes, std::align_val_t{ alignment })) };
+
+	LargeHeader* pHeader{ reinterpret_cast<LargeHeader*>(pMemory + offset) - 1 };
+	*pHeader = LargeHeader{ nullptr, m_pLargeObjects, nbBytes, alignment };
+	if (m_pLargeObjects)
+		m_pLargeObjects->pPrev = pHeader;
+	m_pLargeObjects = pHeader;
+
+	m_Stats.OnAcquire(offset + nbBytes);
+	return pMemory + offset;
+}
+
+void SDBX::Memory::SmallObjectAllocator::ReleaseLarge(void* pData)
+{
+	LargeHeader* pHeader{ static_cast<LargeHeader*>(pData) - 1 };
+	if (pHeader->pPrev)
+		pHeader->pPrev->pNext = pHeader->pNext;
+	else
+		m_pLargeObjects = pHeader->pNext;
+	if (pHeader->pNext)
+		pHeader->pNext->pPrev = pHeader->pPrev;
+
+	const size_t alignment{ pHeader->alignment };
+	const size_t offset{ GetLargeOffset(alignment) };
+	m_Stats.OnRelease(offset + pHeader->nbBytes);
+	::operator delete(static_cast<char*>(pData) - offset, std::align_val_t{ alignment });
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+void SDBX::Memory::SmallObjectAllocator::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = Capacity();
+	snapshot.freeBytes = GetFreeSpaceAmount();
+	snapshot.largestFreeBlock = GetLargestFreeBlock();
+	snapshot.fragmentation = 0.f;
+}
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
+
+namespace SDBX
+{
+	namespace Memory
+	{
+		//Front end for lots of small objects of mixed types (components, small gameplay objects).
+		//Sizes are rounded up to a multiple of SIZE_CLASS_GRANULARITY, each size class is a fixed size pool carving slots out of CHUNK_SIZE chunks,
+		//so objects of the same size end up next to each other and Acquire/Release are a free list pop/push.
+		//Bigger or over-aligned requests are forwarded to the heap with a small header so Release(void*) handles both.
+		//Chunks are kept until the allocator is destroyed and a slot never changes class: the memory of each class stays at its peak.
+		class SmallObjectAllocator final
+		{
+		public:
+			static const size_t SIZE_CLASS_GRANULARITY = 16;
+			static const size_t MAX_SMALL_SIZE = 256;
+			static const size_t SIZE_CLASS_COUNT = MAX_SMALL_SIZE / SIZE_CLASS_GRANULARITY;
+			static const size_t CHUNK_SIZE = 64 * 1024;
+
+			explicit SmallObjectAllocator(const PageBacking& pageBacking = PageBacking{});
+			SmallObjectAllocator(const SmallObjectAllocator& other) = delete;
+			SmallObjectAllocator(SmallObjectAllocator&& other) noexcept = delete;
+			SmallObjectAllocator& operator=(const SmallObjectAllocator& other) = delete;
+			SmallObjectAllocator& operator=(SmallObjectAllocator&& other) noexcept = delete;
+			~SmallObjectAllocator();
+
+			template<typename Typename, typename... Arg_Type>
+			Typename* Acquire(Arg_Type&&... args);
+
+			// Default construct count contiguous elements, alignment can be raised above alignof(Typename)
+			template<typename Typename>
+			Typename* AcquireArray(size_t count, size_t alignment = alignof(Typename));
+
+			void* Acquire(size_t nbBytes, size_t alignment = alignof(std::max_align_t));
+
+			// Polymorphic objects can be released through a base pointer, the memory is found back from the most derived object
+			template<typename Typename>
+			void Release(Typename* pData);
+
+			template<typename Typename>
+			void ReleaseArray(Typename* pFirst, size_t count);
+
+			void Release(void* pData);
+
+			// Chunk memory, large objects are not included
+			size_t Capacity() const { return m_Chunks.size() * CHUNK_SIZE; }
+			// Bytes in free slots of every class, the chunk tails too small for a slot are not counted
+			size_t GetFreeSpaceAmount() const;
+			// Slot size of the biggest class with a free slot, a bigger request needs a new chunk
+			size_t GetLargestFreeBlock() const;
+			// Free slots of the class serving nbBytes, released ones and the ones not carved from its last chunk yet
+			size_t GetFreeSlotCount(size_t nbBytes) const;
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
+		private:
+			struct FreeSlot
+			{
+				FreeSlot* pNext;
+			};
+
+			//released slots are reused first, fresh slots are then bumped from the last chunk of the class
+			struct SizeClass
+			{
+				FreeSlot* pFreeSlot;
+				char* pBump;
+				char* pBumpEnd;
+				size_t freeSlotCount;
+			};
+
+			struct Chunk
+			{
+				char* pBegin;
+				uint32_t sizeClass;
+			};
+
+			//written right before a large object, the list lets the destructor free what was never released
+			struct LargeHeader
+			{
+				LargeHeader* pPrev;
+				LargeHeader* pNext;
+				size_t nbBytes;
+				size_t alignment;
+			};
+
+			inline static uint32_t GetSizeClass(size_t nbBytes) { return uint32_t((nbBytes + SIZE_CLASS_GRANULARITY - 1) / SIZE_CLASS_GRANULARITY) - 1; }
+			inline static size_t GetSlotSize(uint32_t sizeClass) { return size_t(sizeClass + 1) * SIZE_CLASS_GRANULARITY; }
+			inline static size_t GetLargeOffset(size_t alignment) { return AlignUp(sizeof(LargeHeader), alignment); }
+
+			void AddChunk(uint32_t sizeClass);
+			const Chunk* FindChunk(const void* pData) const;
+			void* AcquireLarge(size_t nbBytes, size_t alignment);
+			void ReleaseLarge(void* pData);
+
+			SizeClass m_SizeClasses[SIZE_CLASS_COUNT];
+			//sorted on address, lets Release find the chunk of a pointer with a binary search
+			std::vector<Chunk> m_Chunks;
+			LargeHeader* m_pLargeObjects;
+			PageBacking m_PageBacking;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+		};
+	}
+}
+
+template<typename Typename, typename... Arg_Type>
+Typename* SDBX::Memory::SmallObjectAllocator::Acquire(Arg_Type&&... args)
+{
+	void* pData{ Acquire(sizeof(Typename), alignof(Typename)) };
+	return new (pData) Typename(std::forward<Arg_Type>(args)...);
+}
+
+template<typename Typename>
+Typename* SDBX::Memory::SmallObjectAllocator::AcquireArray(size_t count, size_t alignment)
+{
+	void* pData{ Acquire(sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename)) };
+	return ConstructArray<Typename>(pData, count);
+}
+
+template<typename Typename>
+void SDBX::Memory::SmallObjectAllocator::Release(Typename* pData)
+{
+	void* pMemory{ pData };
+	if constexpr (std::is_polymorphic_v<Typename>)
+		pMemory = dynamic_cast<void*>(pData);
+
+	pData->~Typename();
+	Release(pMemory);
+}
+
+template<typename Typename>
+void SDBX::Memory::SmallObjectAllocator::ReleaseArray(Typename* pFirst, size_t count)
+{
+	DestroyArray(pFirst, count);
+	Release(static_cast<void*>(pFirst));
+}
@@ -1,37 +1,122 @@
 #include "StackAllocator.h"
 
-SDBX::Memory::StackAllocator::StackAllocator(const size_t size)
-	: m_pCurrent((char*)malloc(size))
+#include "Core/Memory/VirtualMemory.h"
+
+SDBX::Memory::StackAllocator::StackAllocator(const size_t size, Backing backing, const PageBacking& pageBacking)
+	: m_pBegin(nullptr)
+	, m_pCurrent(nullptr)
+	, m_pCommitEnd(nullptr)
 	, m_BufferSize(size)
 	, m_FreeSpace(size)
-{}
+	, m_Backing(backing)
+	, m_PageBacking(pageBacking)
+	, m_Stats("StackAllocator")
+{
+	if (m_Backing == Backing::Virtual)
+	{
+		//the reservation is rounded to whole pages so the last commit never runs past it
+		m_BufferSize = AlignUp(size, VirtualMemory::GetPageSize());
+		m_FreeSpace = m_BufferSize;
+		m_pBegin = static_cast<char*>(VirtualMemory::Reserve(m_BufferSize));
+		m_pCommitEnd = m_pBegin;
+
+		if (m_pBegin && !m_PageBacking.UsesHeap())
+			ApplyPageBacking(m_pBegin, m_BufferSize, m_PageBacking);
+	}
+	else
+	{
+		m_pBegin = static_cast<char*>(AcquireBackingMemory(size, alignof(std::max_align_t), m_PageBacking));
+		m_pCommitEnd = m_pBegin + size;
+	}
+
+	SDBX_ASSERT_MSG(m_pBegin != nullptr, "Failed to get the stack memory")
+	m_pCurrent = m_pBegin;
+	m_Stats.Track(this);
+}
 
 SDBX::Memory::StackAllocator::~StackAllocator()
 {
-	Reset();
-	free(m_pCurrent);
+	if (m_Backing == Backing::Virtual)
+		VirtualMemory::Release(m_pBegin, m_BufferSize);
+	else
+		ReleaseBackingMemory(m_pBegin, m_BufferSize, alignof(std::max_align_t), m_PageBacking);
 }
 
-void SDBX::Memory::StackAllocator::FreeToMarker(const Marker marker)
+void SDBX::Memory::StackAllocator::FreeToMarker(const Marker marker, bool decommit)
 {
 	// Reset the stack till the marker
 	m_FreeSpace += size_t(m_pCurrent - marker);
+	m_Stats.OnRelease(size_t(m_pCurrent - marker), 0);
 	m_pCurrent = marker;
+
+	if (decommit)
+		DecommitFrom(marker);
 }
 
-void* SDBX::Memory::StackAllocator::Acquire(size_t nbBytes)
+void* SDBX::Memory::StackAllocator::Acquire(size_t nbBytes, size_t alignment)
 {
-	SDBX_ASSERT_MSG(m_FreeSpace >= nbBytes, "Allocator out of memory")
+	SDBX_ASSERT_MSG(IsValidAlignment(alignment), "Alignment must be a power of two")
 
-	m_FreeSpace -= nbBytes;
-	void* acquiredMemory{ static_cast<void*>(m_pCurrent) };
-	m_pCurrent += nbBytes;
+	const size_t padding{ size_t(AlignUp(m_pCurrent, alignment) - m_pCurrent) };
+
+	SDBX_ASSERT_MSG(m_FreeSpace >= nbBytes + padding, "Allocator out of memory")
+	if (m_FreeSpace < nbBytes + padding)
+		return nullptr;
+
+	if (m_pCurrent + padding + nbBytes > m_pCommitEnd)
+		CommitUpTo(m_pCurrent + padding + nbBytes);
+
+	m_FreeSpace -= nbBytes + padding;
+	m_Stats.OnStackAcquire(nbBytes + padding);
+	void* acquiredMemory{ static_cast<void*>(m_pCurrent + padding) };
+	m_pCurrent += nbBytes + padding;
 	return acquiredMemory;
 }
 
-void SDBX::Memory::StackAllocator::Reset()
+void SDBX::Memory::StackAllocator::Reset(bool decommit)
 {
 	// Free all memory of the stack
-	m_pCurrent -= (m_BufferSize - m_FreeSpace);
+	m_pCurrent = m_pBegin;
 	m_FreeSpace = m_BufferSize;
+	m_Stats.OnReset();
+
+	if (decommit)
+		DecommitFrom(m_pBegin);
+}
+
+void SDBX::Memory::StackAllocator::CommitUpTo(const char* pEnd)
+{
+	//only reachable in Virtual mode, the heap buffer is committed up to its end from the start
+	const size_t committed{ size_t(m_pCommitEnd - m_pBegin) };
+	const size_t stepped{ AlignUp(size_t(pEnd - m_pBegin), VIRTUAL_COMMIT_STEP) };
+	const size_t target{ stepped < m_BufferSize ? stepped : m_BufferSize };
+
+	[[maybe_unused]] const bool isCommitted{ VirtualMemory::Commit(m_pCommitEnd, target - committed) };
+	SDBX_ASSERT_MSG(isCommitted, "Failed to commit stack memory")
+
+	m_pCommitEnd = m_pBegin + target;
+}
+
+void SDBX::Memory::StackAllocator::DecommitFrom(const char* pBegin)
+{
+	if (m_Backing != Backing::Virtual)
+		return;
+
+	//the page holding pBegin may still be in use, only the pages fully above it are given back
+	char* pFirstFreePage{ m_pBegin + AlignUp(size_t(pBegin - m_pBegin), VirtualMemory::GetPageSize()) };
+	if (pFirstFreePage >= m_pCommitEnd)
+		return;
+
+	VirtualMemory::Decommit(pFirstFreePage, size_t(m_pCommitEnd - pFirstFreePage));
+	m_pCommitEnd = pFirstFreePage;
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+void SDBX::Memory::StackAllocator::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = m_BufferSize;
+	snapshot.freeBytes = m_FreeSpace;
+	snapshot.largestFreeBlock = m_FreeSpace;
+	snapshot.fragmentation = 0.f;
 }
+#endif
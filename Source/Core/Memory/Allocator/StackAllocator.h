@@ -2,8 +2,11 @@
 #include <string>
 
 #include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
 
-//FOR POD ONLY, DOESN'T HANDLE NON POD RELEASE 
+//FOR POD ONLY, DOESN'T HANDLE NON POD RELEASE, use the ScopedStackAllocator for objects that need their destructor run
 namespace SDBX
 {
 	namespace Memory
@@ -16,7 +19,19 @@ namespace SDBX
 			StackAllocator& operator=(const StackAllocator& other) = delete;
 			StackAllocator& operator=(StackAllocator&& other) noexcept = delete;
 
-			explicit StackAllocator(size_t size);
+			// Heap mallocs the whole size up front.
+			// Virtual only reserves the address range, pages are committed as the top of the stack moves up so a generous size costs no memory until it is used.
+			enum class Backing
+			{
+				Heap,
+				Virtual
+			};
+
+			// Granularity used to commit pages in Virtual mode, bigger steps mean fewer system calls
+			static const size_t VIRTUAL_COMMIT_STEP = 64 * 1024;
+
+			// pageBacking replaces the heap buffer with pages following the policy, in Virtual mode its hints are applied to the reservation
+			explicit StackAllocator(size_t size, Backing backing = Backing::Heap, const PageBacking& pageBacking = PageBacking{});
 			~StackAllocator();
 
 			using Marker = char*;
@@ -24,37 +39,55 @@ namespace SDBX
 			// Get a marker to the current top of the stack.
 			inline Marker GetMarker() const { return m_pCurrent; }
 
-			// Free the memory up to the given marker
-			void FreeToMarker(Marker marker);
+			// Free the memory up to the given marker, in Virtual mode decommit gives the pages above it back to the system
+			void FreeToMarker(Marker marker, bool decommit = false);
 
 			template<typename Typename, typename... Arg_Type, typename = std::enable_if_t<std::is_trivially_destructible_v<Typename>>>
 			Typename* Acquire(Arg_Type&&... args)
 			{
-				size_t nbBytes = sizeof(Typename);
-
-				SDBX_ASSERT_MSG(m_FreeSpace >= nbBytes, "Allocator out of memory")
-
-					m_FreeSpace -= nbBytes;
-				auto acquiredMemory{ m_pCurrent };
-				m_pCurrent += nbBytes;
-
-				new (acquiredMemory) Typename(std::forward<Arg_Type>(args)...);
+				void* acquiredMemory{ Acquire(sizeof(Typename), alignof(Typename)) };
+				return new (acquiredMemory) Typename(std::forward<Arg_Type>(args)...);
+			}
 
-				return (Typename*)acquiredMemory;
+			// Default construct count contiguous elements, alignment can be raised above alignof(Typename)
+			template<typename Typename, typename = std::enable_if_t<std::is_trivially_destructible_v<Typename>>>
+			Typename* AcquireArray(size_t count, size_t alignment = alignof(Typename))
+			{
+				void* acquiredMemory{ Acquire(sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename)) };
+				return ConstructArray<Typename>(acquiredMemory, count);
 			}
 
-			void* Acquire(size_t);
+			// Acquire raw memory, the top of the stack is moved up to the requested alignment first. nullptr when the stack is full
+			void* Acquire(size_t nbBytes, size_t alignment = 1);
 
-			// Reset the complete stack
-			void Reset();
+			// Reset the complete stack, in Virtual mode decommit gives all its pages back to the system
+			void Reset(bool decommit = false);
 
 			// Get the amount of free memory that is left on the stack.
 			inline size_t GetFreeSpaceAmount() const { return m_FreeSpace; }
 
+			// Memory actually backed by the system, equals the buffer size in Heap mode
+			inline size_t GetCommittedAmount() const { return size_t(m_pCommitEnd - m_pBegin); }
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
 		private:
+			void CommitUpTo(const char* pEnd);
+			void DecommitFrom(const char* pBegin);
+
+			char* m_pBegin;
 			char* m_pCurrent;
-			size_t m_FreeSpace;
+			char* m_pCommitEnd;
 			size_t m_BufferSize;
+			size_t m_FreeSpace;
+			Backing m_Backing;
+			PageBacking m_PageBacking;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "TlsfAllocator.h"
+
+#include "Core/Misc/Bit/BitUtils.h"
+
+SDBX::Memory::TlsfAllocator::TlsfAllocator(size_t initialPoolSize, size_t growSize, const PageBacking& pageBacking)
+	: m_NullBlock()
+	, m_FLBitmap(0)
+	, m_SLBitmaps()
+	, m_Blocks()
+	, m_OwnedPools()
+	, m_PageBacking(pageBacking)
+	, m_GrowSize(growSize)
+	, m_Capacity(0)
+	, m_UsedSpace(0)
+	, m_Stats("TlsfAllocator")
+{
+	//empty lists point to the null block so unlinking never has to check for nullptr
+	m_NullBlock.pNextFree = &m_NullBlock;
+	m_NullBlock.pPrevFree = &m_NullBlock;
+	for (uint32_t fl{}; fl < FL_INDEX_COUNT; ++fl)
+	{
+		for (uint32_t sl{}; sl < SL_INDEX_COUNT; ++sl)
+			m_Blocks[fl][sl] = &m_NullBlock;
+	}
+
+	if (initialPoolSize > 0)
+		AddOwnedPool(initialPoolSize);
+
+	m_Stats.Track(this);
+}
+
+SDBX::Memory::TlsfAllocator::~TlsfAllocator()
+{
+	for (const OwnedPool& pool : m_OwnedPools)
+		ReleaseBackingMemory(pool.pMemory, pool.nbBytes, ALIGN_SIZE, m_PageBacking);
+}
+
+void SDBX::Memory::TlsfAllocator::AddPool(void* pMemory, size_t nbBytes)
+{
+	SDBX_ASSERT_MSG(IsAligned(pMemory, ALIGN_SIZE), "Pool memory must be aligned on ALIGN_SIZE")
+	SDBX_ASSERT_MSG(nbBytes > POOL_OVERHEAD, "Pool is too small")
+
+	const size_t poolSize{ (nbBytes - POOL_OVERHEAD) & ~(ALIGN_SIZE - 1) };
+
+	SDBX_ASSERT_MSG(poolSize >= BLOCK_SIZE_MIN && poolSize <= BLOCK_SIZE_MAX, "Pool size out of the supported range")
+
+	//the first block starts one word before the pool, its pPrevPhysical is never read since there is nothing before it
+	Block* pBlock{ reinterpret_cast<Block*>(static_cast<char*>(pMemory) - BLOCK_OVERHEAD) };
+	pBlock->sizeAndFlags = poolSize;
+	pBlock->SetFree(true);
+	pBlock->SetPrevFree(false);
+	InsertFree(pBlock);
+
+	//zero sized used block closing the pool, stops the merges at the end of the pool
+	Block* pSentinel{ LinkNext(pBlock) };
+	pSentinel->sizeAndFlags = 0;
+	pSentinel->SetFree(false);
+	pSentinel->SetPrevFree(true);
+
+	m_Capacity += poolSize;
+}
+
+void* SDBX::Memory::TlsfAllocator::Acquire(size_t nbBytes, size_t alignment)
+{
+	SDBX_ASSERT_MSG(IsValidAlignment(alignment), "Alignment must be a power of two")
+
+	const size_t adjustedSize{ AdjustRequestSize(nbBytes, ALIGN_SIZE) };
+
+	//over-aligned requests take enough room to move the data forward and split the gap into its own free block
+	const size_t gapMinimum{ sizeof(Block) };
+	const size_t searchSize{ alignment > ALIGN_SIZE ? AdjustRequestSize(adjustedSize + alignment + gapMinimum, ALIGN_SIZE) : adjustedSize };
+
+	SDBX_ASSERT_MSG(adjustedSize > 0 && searchSize > 0, "Request is larger than the largest supported block")
+
+	Block* pBlock{ LocateFree(searchSize) };
+	if (!pBlock && Grow(searchSize))
+		pBlock = LocateFree(searchSize);
+
+	SDBX_ASSERT_MSG(pBlock, "Allocator out of memory")
+	if (!pBlock)
+		return nullptr;
+
+	if (alignment > ALIGN_SIZE)
+	{
+		char* pData{ ToData(pBlock) };
+		char* pAligned{ AlignUp(pData, alignment) };
+		size_t gap{ size_t(pAligned - pData) };
+
+		//a gap too small to hold a free block is pushed to the next aligned address
+		if (gap > 0 && gap < gapMinimum)
+		{
+			const size_t gapRemain{ gapMinimum - gap };
+			pAligned = AlignUp(pAligned + (gapRemain > alignment ? gapRemain : alignment), alignment);
+			gap = size_t(pAligned - pData);
+		}
+
+		if (gap > 0)
+			pBlock = TrimFreeLeading(pBlock, gap);
+	}
+
+	TrimFree(pBlock, adjustedSize);
+	MarkAsUsed(pBlock);
+
+	m_UsedSpace += pBlock->GetSize() + BLOCK_OVERHEAD;
+	m_Stats.OnAcquire(pBlock->GetSize() + BLOCK_OVERHEAD);
+
+	return ToData(pBlock);
+}
+
+void SDBX::Memory::TlsfAllocator::Release(void* pData)
+{
+	if (!pData)
+		return;
+
+	Block* pBlock{ ToBlock(pData) };
+
+	SDBX_ASSERT_MSG(!pBlock->IsFree(), "Block released twice")
+
+	m_UsedSpace -= pBlock->GetSize() + BLOCK_OVERHEAD;
+	m_Stats.OnRelease(pBlock->GetSize() + BLOCK_OVERHEAD);
+
+	MarkAsFree(pBlock);
+	pBlock = MergePrev(pBlock);
+	pBlock = MergeNext(pBlock);
+	InsertFree(pBlock);
+}
+
+size_t SDBX::Memory::TlsfAllocator::GetLargestFreeBlock() const
+{
+	if (m_FLBitmap == 0)
+		return 0;
+
+	//the largest block is in the highest non empty list, blocks of a list only share a size range so it has to be walked
+	const uint32_t fl{ Bit::FindLastSet(m_FLBitmap) };
+	const uint32_t sl{ Bit::FindLastSet(m_SLBitmaps[fl]) };
+
+	size_t largestFreeBlock{};
+	for (const Block* pBlock{ m_Blocks[fl][sl] }; pBlock != &m_NullBlock; pBlock = pBlock->pNextFree)
+		largestFreeBlock = pBlock->GetSize() > largestFreeBlock ? pBlock->GetSize() : largestFreeBlock;
+
+	return largestFreeBlock;
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+void SDBX::Memory::TlsfAllocator::FillSnapshot(AllocatorSnapshot& snapshot) const
+{
+	snapshot.capacity = Capacity();
+	snapshot.freeBytes = GetFreeSpaceAmount();
+	snapshot.largestFreeBlock = GetLargestFreeBlock();
+	snapshot.fragmentation = ComputeFragmentation(snapshot.largestFreeBlock, snapshot.freeBytes);
+}
+#endif
+
+void SDBX::Memory::TlsfAllocator::MappingInsert(size_t size, uint32_t& fl, uint32_t& sl)
+{
+	if (size < SMALL_BLOCK_SIZE)
+	{
+		fl = 0;
+		sl = uint32_t(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+	}
+	else
+	{
+		const uint32_t log2Size{ Bit::FindLastSet(size) };
+		sl = uint32_t(size >> (log2Size - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+		fl = log2Size - (FL_INDEX_SHIFT - 1);
+	}
+}
+
+void SDBX::Memory::TlsfAllocator::MappingSearch(size_t size, uint32_t& fl, uint32_t& sl)
+{
+	//round up to the next list so any block found in it is large enough, no list walk needed
+	if (size >= SMALL_BLOCK_SIZE)
+		size += (size_t(1) << (Bit::FindLastSet(size) - SL_INDEX_COUNT_LOG2)) - 1;
+
+	MappingInsert(size, fl, sl);
+}
+
+size_t SDBX::Memory::TlsfAllocator::AdjustRequestSize(size_t nbBytes, size_t alignment)
+{
+	const size_t aligned{ AlignUp(nbBytes, alignment) };
+	if (aligned >= BLOCK_SIZE_MAX)
+		return 0;
+
+	return aligned > BLOCK_SIZE_MIN ? aligned : BLOCK_SIZE_MIN;
+}
+
+SDBX::Memory::TlsfAllocator::Block* SDBX::Memory::TlsfAllocator::LocateFree(size_t size)
+{
+	uint32_t fl{}, sl{};
+	MappingSearch(size, fl, sl);
+
+	if (fl >= FL_INDEX_COUNT)
+		return nullptr;
+
+	Block* pBlock{ FindSuitableBlock(fl, sl) };
+	if (pBlock)
+		RemoveFree(pBlock, fl, sl);
+
+	return pBlock;
+}
+
+SDBX::Memory::TlsfAllocator::Block* SDBX::Memory::TlsfAllocator::FindSuitableBlock(uint32_t& fl, uint32_t& sl) const
+{
+	//first non empty list at or above sl in the same first level, otherwise the smallest list of the next non empty first level
+	uint32_t slMap{ m_SLBitmaps[fl] & (~uint32_t(0) << sl) };
+	if (!slMap)
+	{
+		const uint32_t flMap{ fl + 1 < 32 ? m_FLBitmap & (~uint32_t(0) << (fl + 1)) : 0 };
+		if (!flMap)
+			return nullptr;
+
+		fl = Bit::FindFirstSet(flMap);
+		slMap = m_SLBitmaps[fl];
+	}
+
+	sl = Bit::FindFirstSet(slMap);
+	return m_Blocks[fl][sl];
+}
+
+void SDBX::Memory::TlsfAllocator::InsertFree(Block* pBlock)
+{
+	uint32_t fl{}, sl{};
+	MappingInsert(pBlock->GetSize(), fl, sl);
+
+	Block* pCurrent{ m_Blocks[fl][sl] };
+	pBlock->pNextFree = pCurrent;
+	pBlock->pPrevFree = &m_NullBlock;
+	pCurrent->pPrevFree = pBlock;
+
+	m_Blocks[fl][sl] = pBlock;
+	m_FLBitmap |= uint32_t(1) << fl;
+	m_SLBitmaps[fl] |= uint32_t(1) << sl;
+}
+
+void SDBX::Memory::TlsfAllocator::RemoveFree(Block* pBlock)
+{
+	uint32_t fl{}, sl{};
+	MappingInsert(pBlock->GetSize(), fl, sl);
+	RemoveFree(pBlock, fl, sl);
+}
+
+void SDBX::Memory::TlsfAllocator::RemoveFree(Block* pBlock, uint32_t fl, uint32_t sl)
+{
+	Block* pPrev{ pBlock->pPrevFree };
+	Block* pNext{ pBlock->pNextFree };
+	pNext->pPrevFree = pPrev;
+	pPrev->pNextFree = pNext;
+
+	if (m_Blocks[fl][sl] == pBlock)
+	{
+		m_Blocks[fl][sl] = pNext;
+		if (pNext == &m_NullBlock)
+		{
+			m_SLBitmaps[fl] &= ~(uint32_t(1) << sl);
+			if (!m_SLBitmaps[fl])
+				m_FLBitmap &= ~(uint32_t(1) << fl);
+		}
+	}
+}
+
+SDBX::Memory::TlsfAllocator::Block* SDBX::Memory::TlsfAllocator::Split(Block* pBlock, size_t size)
+{
+	Block* pRemaining{ reinterpret_cast<Block*>(ToData(pBlock) + size - BLOCK_OVERHEAD) };
+	const size_t remainingSize{ pBlock->GetSize() - (size + BLOCK_OVERHEAD) };
+
+	pRemaining->sizeAndFlags = 0;
+	pRemaining->SetSize(remainingSize);
+	pBlock->SetSize(size);
+	MarkAsFree(pRemaining);
+
+	return pRemaining;
+}
+
+SDBX::Memory::TlsfAllocator::Block* SDBX::Memory::TlsfAllocator::Absorb(Block* pPrev, Block* pBlock)
+{
+	pPrev->SetSize(pPrev->GetSize() + pBlock->GetSize() + BLOCK_OVERHEAD);
+	LinkNext(pPrev);
+	return pPrev;
+}
+
+SDBX::Memory::TlsfAllocator::Block* SDBX::Memory::TlsfAllocator::MergePrev(Block* pBlock)
+{
+	if (pBlock->IsPrevFree())
+	{
+		Block* pPrev{ pBlock->pPrevPhysical };
+		RemoveFree(pPrev);
+		pBlock = Absorb(pPrev, pBlock);
+	}
+
+	return pBlock;
+}
+
+SDBX::Memory::TlsfAllocator::Block* SDBX::Memory::TlsfAllocator::MergeNext(Block* pBlock)
+{
+	Block* pNext{ GetNext(pBlock) };
+	if (pNext->IsFree())
+	{
+		RemoveFree(pNext);
+		pBlock = Absorb(pBlock, pNext);
+	}
+
+	return pBlock;
+}
+
+void SDBX::Memory::TlsfAllocator::TrimFree(Block* pBlock, size_t size)
+{
+	//give the tail back if it can hold a block on its own
+	if (pBlock->GetSize() >= sizeof(Block) + size)
+	{
+		Block* pRemaining{ Split(pBlock, size) };
+		LinkNext(pBlock);
+		pRemaining->SetPrevFree(true);
+		InsertFree(pRemaining);
+	}
+}
+
+SDBX::Memory::TlsfAllocator::Block* SDBX::Memory::TlsfAllocator::TrimFreeLeading(Block* pBlock, size_t size)
+{
+	//size is the distance between the data of the block and the aligned data, the leading part goes back to the free lists
+	Block* pRemaining{ pBlock };
+	if (pBlock->GetSize() >= sizeof(Block) + size)
+	{
+		pRemaining = Split(pBlock, size - BLOCK_OVERHEAD);
+		pRemaining->SetPrevFree(true);
+		LinkNext(pBlock);
+		InsertFree(pBlock);
+	}
+
+	return pRemaining;
+}
+
+void SDBX::Memory::TlsfAllocator::MarkAsFree(Block* pBlock)
+{
+	Block* pNext{ LinkNext(pBlock) };
+	pNext->SetPrevFree(true);
+	pBlock->SetFree(true);
+}
+
+void SDBX::Memory::TlsfAllocator::MarkAsUsed(Block* pBlock)
+{
+	Block* pNext{ GetNext(pBlock) };
+	pNext->SetPrevFree(false);
+	pBlock->SetFree(false);
+}
+
+bool SDBX::Memory::TlsfAllocator::Grow(size_t size)
+{
+	if (m_GrowSize == 0)
+		return false;
+
+	//the new pool must hold the request after the search round up, twice the size is always enough
+	const size_t poolSize{ m_GrowSize > size * 2 + POOL_OVERHEAD ? m_GrowSize : size * 2 + POOL_OVERHEAD };
+	return AddOwnedPool(poolSize);
+}
+
+bool SDBX::Memory::TlsfAllocator::AddOwnedPool(size_t poolSize)
+{
+	void* pPool{ AcquireBackingMemory(poolSize, ALIGN_SIZE, m_PageBacking) };
+	if (!pPool)
+		return false;
+
+	m_OwnedPools.push_back(OwnedPool{ pPool, poolSize });
+	AddPool(pPool, poolSize);
+	return true;
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryStats.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/PageBacking.h"
+
+namespace SDBX
+{
+	namespace Memory
+	{
+		//Two-Level Segregated Fit heap, the recommended general purpose allocator for objects with unpredictable lifetimes.
+		//Free blocks are indexed by size in two levels: the first level is the power of two of the size, the second splits it in SL_INDEX_COUNT linear ranges.
+		//A bitmap per level gives the first non empty list with two bit scans, Acquire and Release are O(1) and free neighbors are merged immediately.
+		//Memory comes from pools, the allocator grows by adding a new pool when it runs out if a grow size was given (the only non O(1) path).
+		class TlsfAllocator final
+		{
+		public:
+			static const size_t ALIGN_SIZE = sizeof(void*);
+
+			// initialPoolSize == 0 starts without memory, growSize == 0 never grows past the pools added by hand
+			// Pools the allocator creates itself are acquired with pageBacking
+			explicit TlsfAllocator(size_t initialPoolSize, size_t growSize = 0, const PageBacking& pageBacking = PageBacking{});
+			TlsfAllocator(const TlsfAllocator& other) = delete;
+			TlsfAllocator(TlsfAllocator&& other) noexcept = delete;
+			TlsfAllocator& operator=(const TlsfAllocator& other) = delete;
+			TlsfAllocator& operator=(TlsfAllocator&& other) noexcept = delete;
+			~TlsfAllocator();
+
+			// Hand an external range to the allocator, it must outlive the allocator and be aligned on ALIGN_SIZE
+			void AddPool(void* pMemory, size_t nbBytes);
+
+			template<typename Typename, typename... Arg_Type>
+			Typename* Acquire(Arg_Type&&... args);
+
+			// Default construct count contiguous elements, alignment can be raised above alignof(Typename)
+			template<typename Typename>
+			Typename* AcquireArray(size_t count, size_t alignment = alignof(Typename));
+
+			void* Acquire(size_t nbBytes, size_t alignment = ALIGN_SIZE);
+
+			template<typename Typename>
+			void Release(Typename* pData);
+
+			template<typename Typename>
+			void ReleaseArray(Typename* pFirst, size_t count);
+
+			void Release(void* pData);
+
+			// Sizes include the per block overhead
+			size_t Capacity() const { return m_Capacity; }
+			size_t GetFreeSpaceAmount() const { return m_Capacity - m_UsedSpace; }
+			size_t GetLargestFreeBlock() const;
+
+			// Name and tag the allocator is reported under in memory stats
+			void SetStatsInfo(const char* name, MemoryTag tag) { m_Stats.SetInfo(name, tag); }
+
+#if SDBX_MEMORY_STATS_ENABLED
+			void FillSnapshot(AllocatorSnapshot& snapshot) const;
+#endif
+
+		private:
+			static const uint32_t SL_INDEX_COUNT_LOG2 = 5;
+			static const uint32_t SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+			static const uint32_t ALIGN_SIZE_LOG2 = sizeof(void*) == 8 ? 3 : 2;
+			//sizes below SMALL_BLOCK_SIZE all go in the first level, split in SL_INDEX_COUNT linear lists
+			static const uint32_t FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2;
+			static const uint32_t FL_INDEX_MAX = sizeof(void*) == 8 ? 32 : 30;
+			static const uint32_t FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+			static const size_t SMALL_BLOCK_SIZE = size_t(1) << FL_INDEX_SHIFT;
+
+			//pPrevPhysical is stored in the last word of the previous block and only valid while that block is free.
+			//The free list links overlap the data of the block, a used block only costs its size word.
+			struct Block
+			{
+				Block* pPrevPhysical;
+				size_t sizeAndFlags;
+				Block* pNextFree;
+				Block* pPrevFree;
+
+				static const size_t FREE_FLAG = 1;
+				static const size_t PREV_FREE_FLAG = 2;
+
+				size_t GetSize() const { return sizeAndFlags & ~(FREE_FLAG | PREV_FREE_FLAG); }
+				void SetSize(size_t size) { sizeAndFlags = size | (sizeAndFlags & (FREE_FLAG | PREV_FREE_FLAG)); }
+				bool IsFree() const { return sizeAndFlags & FREE_FLAG; }
+				void SetFree(bool isFree) { sizeAndFlags = isFree ? sizeAndFlags | FREE_FLAG : sizeAndFlags & ~FREE_FLAG; }
+				bool IsPrevFree() const { return sizeAndFlags & PREV_FREE_FLAG; }
+				void SetPrevFree(bool isPrevFree) { sizeAndFlags = isPrevFree ? sizeAndFlags | PREV_FREE_FLAG : sizeAndFlags & ~PREV_FREE_FLAG; }
+			};
+
+			static const size_t BLOCK_OVERHEAD = sizeof(size_t);
+			static const size_t DATA_OFFSET = offsetof(Block, sizeAndFlags) + sizeof(size_t);
+			static const size_t BLOCK_SIZE_MIN = sizeof(Block) - sizeof(Block*);
+			static const size_t BLOCK_SIZE_MAX = size_t(1) << FL_INDEX_MAX;
+			//first block overhead + zero sized sentinel closing the pool
+			static const size_t POOL_OVERHEAD = 2 * BLOCK_OVERHEAD;
+
+			Block m_NullBlock;
+			uint32_t m_FLBitmap;
+			uint32_t m_SLBitmaps[FL_INDEX_COUNT];
+			Block* m_Blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+			struct OwnedPool
+			{
+				void* pMemory;
+				size_t nbBytes;
+			};
+
+			std::vector<OwnedPool> m_OwnedPools;
+			PageBacking m_PageBacking;
+			size_t m_GrowSize;
+			size_t m_Capacity;
+			size_t m_UsedSpace;
+			SDBX_NO_UNIQUE_ADDRESS AllocatorStats m_Stats;
+
+			inline static char* ToData(Block* pBlock) { return reinterpret_cast<char*>(pBlock) + DATA_OFFSET; }
+			inline static Block* ToBlock(void* pData) { return reinterpret_cast<Block*>(static_cast<char*>(pData) - DATA_OFFSET); }
+			inline static Block* GetNext(Block* pBlock) { return reinterpret_cast<Block*>(ToData(pBlock) + pBlock->GetSize() - BLOCK_OVERHEAD); }
+			inline static Block* LinkNext(Block* pBlock) { Block* pNext{ GetNext(pBlock) }; pNext->pPrevPhysical = pBlock; return pNext; }
+
+			static void MappingInsert(size_t size, uint32_t& fl, uint32_t& sl);
+			static void MappingSearch(size_t size, uint32_t& fl, uint32_t& sl);
+			static size_t AdjustRequestSize(size_t nbBytes, size_t alignment);
+
+			Block* LocateFree(size_t size);
+			Block* FindSuitableBlock(uint32_t& fl, uint32_t& sl) const;
+			void InsertFree(Block* pBlock);
+			void RemoveFree(Block* pBlock);
+			void RemoveFree(Block* pBlock, uint32_t fl, uint32_t sl);
+
+			Block* Split(Block* pBlock, size_t size);
+			Block* Absorb(Block* pPrev, Block* pBlock);
+			Block* MergePrev(Block* pBlock);
+			Block* MergeNext(Block* pBlock);
+			void TrimFree(Block* pBlock, size_t size);
+			Block* TrimFreeLeading(Block* pBlock, size_t size);
+			void MarkAsFree(Block* pBlock);
+			void MarkAsUsed(Block* pBlock);
+
+			bool Grow(size_t size);
+			bool AddOwnedPool(size_t poolSize);
+		};
+	}
+}
+
+template<typename Typename, typename... Arg_Type>
+Typename* SDBX::Memory::TlsfAllocator::Acquire(Arg_Type&&... args)
+{
+	void* pData{ Acquire(sizeof(Typename), alignof(Typename)) };
+	return new (pData) Typename(std::forward<Arg_Type>(args)...);
+}
+
+template<typename Typename>
+Typename* SDBX::Memory::TlsfAllocator::AcquireArray(size_t count, size_t alignment)
+{
+	void* pData{ Acquire(sizeof(Typename) * count, alignment > alignof(Typename) ? alignment : alignof(Typename)) };
+	return ConstructArray<Typename>(pData, count);
+}
+
+template<typename Typename>
+void SDBX::Memory::TlsfAllocator::Release(Typename* pData)
+{
+	pData->~Typename();
+	Release(static_cast<void*>(pData));
+}
+
+template<typename Typename>
+void SDBX::Memory::TlsfAllocator::ReleaseArray(Typename* pFirst, size_t count)
+{
+	DestroyArray(pFirst, count);
+	Release(static_cast<void*>(pFirst));
+}
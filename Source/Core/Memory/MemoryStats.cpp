@@ -0,0 +1,146 @@
+#include "MemoryStats.h"
+
+#include <algorithm>
+
+const char* SDBX::Memory::GetMemoryTagName(MemoryTag tag)
+{
+	switch (tag)
+	{
+	case MemoryTag::General: return "General";
+	case MemoryTag::Frame: return "Frame";
+	case MemoryTag::Gameplay: return "Gameplay";
+	case MemoryTag::Rendering: return "Rendering";
+	case MemoryTag::Resources: return "Resources";
+	default: return "Unknown";
+	}
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+SDBX::Memory::AllocatorStats::AllocatorStats(const char* name, MemoryTag tag)
+	: m_Name(name)
+	, m_Tag(tag)
+	, m_CurrentBytes(0)
+	, m_PeakBytes(0)
+	, m_LiveAllocations(0)
+	, m_TotalAllocations(0)
+{}
+
+SDBX::Memory::AllocatorStats::~AllocatorStats()
+{
+	OnReset();
+	MemoryStats::GetInstance().Unregister(this);
+}
+
+void SDBX::Memory::AllocatorStats::SetInfo(const char* name, MemoryTag tag)
+{
+	MemoryStats& memoryStats{ MemoryStats::GetInstance() };
+	memoryStats.OnRelease(m_Tag, m_CurrentBytes, m_LiveAllocations);
+	memoryStats.OnAcquire(tag, m_CurrentBytes, m_LiveAllocations);
+
+	m_Name = name;
+	m_Tag = tag;
+}
+
+void SDBX::Memory::AllocatorStats::OnAcquire(size_t nbBytes, size_t nbAllocations)
+{
+	m_CurrentBytes += nbBytes;
+	m_PeakBytes = std::max(m_PeakBytes, m_CurrentBytes);
+	m_LiveAllocations += nbAllocations;
+	m_TotalAllocations += nbAllocations;
+
+	MemoryStats::GetInstance().OnAcquire(m_Tag, nbBytes, nbAllocations);
+}
+
+void SDBX::Memory::AllocatorStats::OnStackAcquire(size_t nbBytes)
+{
+	m_CurrentBytes += nbBytes;
+	m_PeakBytes = std::max(m_PeakBytes, m_CurrentBytes);
+	++m_TotalAllocations;
+
+	MemoryStats::GetInstance().OnAcquire(m_Tag, nbBytes, 0);
+}
+
+void SDBX::Memory::AllocatorStats::OnRelease(size_t nbBytes, size_t nbAllocations)
+{
+	m_CurrentBytes -= nbBytes;
+	m_LiveAllocations -= nbAllocations;
+
+	MemoryStats::GetInstance().OnRelease(m_Tag, nbBytes, nbAllocations);
+}
+
+void SDBX::Memory::AllocatorStats::OnReset()
+{
+	OnRelease(m_CurrentBytes, m_LiveAllocations);
+}
+
+void SDBX::Memory::AllocatorStats::Fill(AllocatorSnapshot& snapshot) const
+{
+	snapshot.name = m_Name;
+	snapshot.tag = m_Tag;
+	snapshot.currentBytes = m_CurrentBytes;
+	snapshot.peakBytes = m_PeakBytes;
+	snapshot.liveAllocations = m_LiveAllocations;
+	snapshot.totalAllocations = m_TotalAllocations;
+}
+
+SDBX::Memory::MemoryStats::MemoryStats()
+	: m_Mutex()
+	, m_Entries()
+	, m_Tags()
+{}
+
+void SDBX::Memory::MemoryStats::Register(const AllocatorStats* pStats, const void* pOwner, FillFunction pFill)
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	m_Entries.push_back(Entry{ pStats, pOwner, pFill });
+}
+
+void SDBX::Memory::MemoryStats::Unregister(const AllocatorStats* pStats)
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	m_Entries.erase(std::remove_if(std::begin(m_Entries), std::end(m_Entries), [pStats](const Entry& entry) { return entry.pStats == pStats; }), std::end(m_Entries));
+}
+
+void SDBX::Memory::MemoryStats::OnAcquire(MemoryTag tag, size_t nbBytes, size_t nbAllocations)
+{
+	TagCounters& counters{ m_Tags[size_t(tag)] };
+	const size_t currentBytes{ counters.currentBytes.fetch_add(nbBytes, std::memory_order_relaxed) + nbBytes };
+	counters.liveAllocations.fetch_add(nbAllocations, std::memory_order_relaxed);
+
+	size_t peakBytes{ counters.peakBytes.load(std::memory_order_relaxed) };
+	while (peakBytes < currentBytes && !counters.peakBytes.compare_exchange_weak(peakBytes, currentBytes, std::memory_order_relaxed))
+	{
+	}
+}
+
+void SDBX::Memory::MemoryStats::OnRelease(MemoryTag tag, size_t nbBytes, size_t nbAllocations)
+{
+	TagCounters& counters{ m_Tags[size_t(tag)] };
+	counters.currentBytes.fetch_sub(nbBytes, std::memory_order_relaxed);
+	counters.liveAllocations.fetch_sub(nbAllocations, std::memory_order_relaxed);
+}
+
+SDBX::Memory::MemorySnapshot SDBX::Memory::MemoryStats::TakeSnapshot() const
+{
+	MemorySnapshot snapshot{};
+
+	for (size_t tagIdx{}; tagIdx < size_t(MemoryTag::Count); ++tagIdx)
+	{
+		snapshot.tags[tagIdx].currentBytes = m_Tags[tagIdx].currentBytes.load(std::memory_order_relaxed);
+		snapshot.tags[tagIdx].peakBytes = m_Tags[tagIdx].peakBytes.load(std::memory_order_relaxed);
+		snapshot.tags[tagIdx].liveAllocations = m_Tags[tagIdx].liveAllocations.load(std::memory_order_relaxed);
+	}
+
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	snapshot.allocators.reserve(m_Entries.size());
+	for (const Entry& entry : m_Entries)
+	{
+		AllocatorSnapshot allocatorSnapshot{};
+		entry.pStats->Fill(allocatorSnapshot);
+		entry.pFill(entry.pOwner, allocatorSnapshot);
+		snapshot.allocators.push_back(allocatorSnapshot);
+	}
+
+	return snapshot;
+}
+#endif
@@ -0,0 +1,181 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(SDBX_MEMORY_STATS) || defined(_DEBUG) || defined(DEBUG)
+	#define SDBX_MEMORY_STATS_ENABLED 1
+#else
+	#define SDBX_MEMORY_STATS_ENABLED 0
+#endif
+
+//Put on the AllocatorStats members so the disabled one takes no room in its owner, MSVC ignores the standard spelling
+#if defined(_MSC_VER)
+	#define SDBX_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+	#define SDBX_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+#if SDBX_MEMORY_STATS_ENABLED
+	#include <atomic>
+	#include <mutex>
+
+	#include "Core/Base/Singleton.h"
+#endif
+
+//Optional usage tracking for the allocators, enabled in debug or with SDBX_MEMORY_STATS.
+//Every allocator owns an AllocatorStats that counts what goes through it and a tag (subsystem) its bytes are accounted to.
+//When disabled AllocatorStats is empty and all its calls are inlined no-ops.
+//Stack allocators free everything above a marker without knowing how many allocations it holds, they only report bytes:
+//their acquires count in totalAllocations but never in liveAllocations.
+namespace SDBX
+{
+	namespace Memory
+	{
+		enum class MemoryTag : uint8_t
+		{
+			General
+			, Frame
+			, Gameplay
+			, Rendering
+			, Resources
+			, Count
+		};
+
+		const char* GetMemoryTagName(MemoryTag tag);
+
+		// State of one allocator, all sizes in bytes and including the allocator bookkeeping (headers, padding, slot size)
+		struct AllocatorSnapshot
+		{
+			const char* name;
+			MemoryTag tag;
+			size_t capacity;
+			size_t currentBytes;
+			size_t peakBytes;
+			size_t liveAllocations;
+			size_t totalAllocations;
+			size_t freeBytes;
+			size_t largestFreeBlock;
+			// 0 when the free memory is one block, tends to 1 as it gets split in small blocks. Always 0 for fixed size pools
+			float fragmentation;
+		};
+
+		struct TagSnapshot
+		{
+			size_t currentBytes;
+			size_t peakBytes;
+			size_t liveAllocations;
+		};
+
+		struct MemorySnapshot
+		{
+			std::vector<AllocatorSnapshot> allocators;
+			TagSnapshot tags[size_t(MemoryTag::Count)];
+		};
+
+		inline float ComputeFragmentation(size_t largestFreeBlock, size_t freeBytes) { return freeBytes > 0 ? 1.f - float(largestFreeBlock) / float(freeBytes) : 0.f; }
+
+#if SDBX_MEMORY_STATS_ENABLED
+		class AllocatorStats final
+		{
+		public:
+			explicit AllocatorStats(const char* name, MemoryTag tag = MemoryTag::General);
+			AllocatorStats(const AllocatorStats& other) = delete;
+			AllocatorStats(AllocatorStats&& other) noexcept = delete;
+			AllocatorStats& operator=(const AllocatorStats& other) = delete;
+			AllocatorStats& operator=(AllocatorStats&& other) noexcept = delete;
+			~AllocatorStats();
+
+			// Make the owner show up in MemoryStats snapshots, Owner must implement FillSnapshot(AllocatorSnapshot&) const
+			template<typename Owner>
+			void Track(const Owner* pOwner);
+
+			// Live bytes move along to the new tag
+			void SetInfo(const char* name, MemoryTag tag);
+
+			void OnAcquire(size_t nbBytes, size_t nbAllocations = 1);
+			// Bytes only, for stack allocators
+			void OnStackAcquire(size_t nbBytes);
+			void OnRelease(size_t nbBytes, size_t nbAllocations = 1);
+			void OnReset();
+
+			void Fill(AllocatorSnapshot& snapshot) const;
+
+		private:
+			const char* m_Name;
+			MemoryTag m_Tag;
+			size_t m_CurrentBytes;
+			size_t m_PeakBytes;
+			size_t m_LiveAllocations;
+			size_t m_TotalAllocations;
+		};
+
+		//Registry of the tracked allocators and per tag totals.
+		//Snapshots read the allocators without locking them, take them at a point where they are idle (end of frame).
+		class MemoryStats final : public Singleton<MemoryStats>
+		{
+		public:
+			using FillFunction = void(*)(const void* pOwner, AllocatorSnapshot& snapshot);
+
+			~MemoryStats() override = default;
+			MemoryStats(const MemoryStats& other) = delete;
+			MemoryStats(MemoryStats&& other) noexcept = delete;
+			MemoryStats& operator=(const MemoryStats& other) = delete;
+			MemoryStats& operator=(MemoryStats&& other) noexcept = delete;
+
+			void Register(const AllocatorStats* pStats, const void* pOwner, FillFunction pFill);
+			void Unregister(const AllocatorStats* pStats);
+
+			void OnAcquire(MemoryTag tag, size_t nbBytes, size_t nbAllocations);
+			void OnRelease(MemoryTag tag, size_t nbBytes, size_t nbAllocations);
+
+			MemorySnapshot TakeSnapshot() const;
+
+		private:
+			friend class Singleton<MemoryStats>;
+			explicit MemoryStats();
+
+			struct Entry
+			{
+				const AllocatorStats* pStats;
+				const void* pOwner;
+				FillFunction pFill;
+			};
+
+			struct TagCounters
+			{
+				std::atomic<size_t> currentBytes;
+				std::atomic<size_t> peakBytes;
+				std::atomic<size_t> liveAllocations;
+			};
+
+			mutable std::mutex m_Mutex;
+			std::vector<Entry> m_Entries;
+			TagCounters m_Tags[size_t(MemoryTag::Count)];
+		};
+#else
+		class AllocatorStats final
+		{
+		public:
+			explicit AllocatorStats(const char*, MemoryTag = MemoryTag::General) {}
+
+			template<typename Owner>
+			void Track(const Owner*) {}
+
+			void SetInfo(const char*, MemoryTag) {}
+			void OnAcquire(size_t, size_t = 1) {}
+			void OnStackAcquire(size_t) {}
+			void OnRelease(size_t, size_t = 1) {}
+			void OnReset() {}
+		};
+#endif
+	}
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+template<typename Owner>
+void SDBX::Memory::AllocatorStats::Track(const Owner* pOwner)
+{
+	MemoryStats::GetInstance().Register(this, pOwner, [](const void* pO, AllocatorSnapshot& snapshot) { static_cast<const Owner*>(pO)->FillSnapshot(snapshot); });
+}
+#endif
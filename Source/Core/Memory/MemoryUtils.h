@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Core/Misc/Bit/BitUtils.h"
+
+namespace SDBX
+{
+	namespace Memory
+	{
+		inline constexpr size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+		template<typename Typename>
+		inline Typename* AlignUp(Typename* ptr, size_t alignment) { return reinterpret_cast<Typename*>(AlignUp(reinterpret_cast<uintptr_t>(ptr), alignment)); }
+
+		inline bool IsAligned(const void* ptr, size_t alignment) { return (reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) == 0; }
+
+		inline constexpr bool IsValidAlignment(size_t alignment) { return Bit::IsPowerOfTwo(alignment); }
+
+		// Construct count objects in place, each from a copy of the given arguments
+		template<typename Typename, typename... Arg_Type>
+		Typename* ConstructArray(void* pMemory, size_t count, const Arg_Type&... args)
+		{
+			Typename* pFirst{ static_cast<Typename*>(pMemory) };
+			for (size_t idx{}; idx < count; ++idx)
+				new (pFirst + idx) Typename(args...);
+
+			return pFirst;
+		}
+
+		template<typename Typename>
+		void DestroyArray(Typename* pFirst, size_t count)
+		{
+			if constexpr (!std::is_trivially_destructible_v<Typename>)
+			{
+				for (size_t idx{ count }; idx > 0; --idx)
+					pFirst[idx - 1].~Typename();
+			}
+		}
+	}
+}
@@ -0,0 +1,195 @@
+#include "PageBacking.h"
+
+#include <new>
+
+#include "Core/Log/Logger.h"
+#include "Core/Memory/MemoryUtils.h"
+#include "Core/Memory/VirtualMemory.h"
+
+#if defined(_WIN32)
+	#include <Windows.h>
+#else
+	#include <cstdio>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+	size_t GetHugePageSize()
+	{
+#if defined(_WIN32)
+		//0 when the system doesn't support large pages
+		static const size_t hugePageSize{ size_t(GetLargePageMinimum()) };
+#else
+		static const size_t hugePageSize{ []()
+		{
+			size_t pmdSize{ 2 * 1024 * 1024 };
+			if (FILE* pFile{ fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r") })
+			{
+				unsigned long long value{};
+				if (fscanf(pFile, "%llu", &value) == 1 && value > 0)
+					pmdSize = size_t(value);
+				fclose(pFile);
+			}
+			return pmdSize;
+		}() };
+#endif
+		return hugePageSize;
+	}
+
+	size_t GetMappingGranularity(const SDBX::Memory::PageBacking& backing)
+	{
+		const size_t pageSize{ SDBX::Memory::VirtualMemory::GetPageSize() };
+		if (backing.pageSize != SDBX::Memory::PageBacking::PageSize::Huge)
+			return pageSize;
+
+		const size_t hugePageSize{ GetHugePageSize() };
+		return hugePageSize > pageSize ? hugePageSize : pageSize;
+	}
+
+	void* MapPages(size_t mappedSize, const SDBX::Memory::PageBacking& backing)
+	{
+		const bool isHuge{ backing.pageSize == SDBX::Memory::PageBacking::PageSize::Huge };
+
+#if defined(_WIN32)
+		const DWORD node{ backing.numaNode != SDBX::Memory::PageBacking::ANY_NODE ? DWORD(backing.numaNode) : NUMA_NO_PREFERRED_NODE };
+
+		//large pages need the SeLockMemoryPrivilege, without it the call fails and normal pages are used
+		if (isHuge && GetHugePageSize() > 0)
+		{
+			if (void* pMemory{ VirtualAllocExNuma(GetCurrentProcess(), nullptr, mappedSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node) })
+				return pMemory;
+		}
+
+		return VirtualAllocExNuma(GetCurrentProcess(), nullptr, mappedSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+#else
+		if (!isHuge)
+		{
+			void* pMemory{ mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+			return pMemory != MAP_FAILED ? pMemory : nullptr;
+		}
+
+#if defined(MAP_HUGETLB)
+		//explicit huge pages only exist if the admin reserved a pool for them
+		void* pHugeTlb{ mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0) };
+		if (pHugeTlb != MAP_FAILED)
+			return pHugeTlb;
+#endif
+
+		//transparent huge pages only back huge page aligned ranges, map one extra huge page and trim both ends
+		const size_t hugePageSize{ GetMappingGranularity(backing) };
+		char* pMapped{ static_cast<char*>(mmap(nullptr, mappedSize + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) };
+		if (pMapped == MAP_FAILED)
+			return nullptr;
+
+		char* pAligned{ SDBX::Memory::AlignUp(pMapped, hugePageSize) };
+		const size_t headSize{ size_t(pAligned - pMapped) };
+		if (headSize > 0)
+			munmap(pMapped, headSize);
+		if (hugePageSize - headSize > 0)
+			munmap(pAligned + mappedSize, hugePageSize - headSize);
+
+		return pAligned;
+#endif
+	}
+
+	void TouchPages(void* pMemory, size_t mappedSize, size_t granularity)
+	{
+		//volatile so the writes are not dropped, one write per page is enough to fault it in
+		volatile char* pPage{ static_cast<char*>(pMemory) };
+		for (size_t offset{}; offset < mappedSize; offset += granularity)
+			pPage[offset] = 0;
+	}
+}
+
+SDBX::Memory::PageBacking SDBX::Memory::PageBacking::Local(PageSize pageSize)
+{
+	PageBacking backing{};
+	backing.pageSize = pageSize;
+	backing.numaNode = GetCurrentNumaNode();
+	backing.firstTouch = true;
+	return backing;
+}
+
+int SDBX::Memory::GetCurrentNumaNode()
+{
+#if defined(_WIN32)
+	PROCESSOR_NUMBER processor{};
+	GetCurrentProcessorNumberEx(&processor);
+
+	USHORT node{};
+	return GetNumaProcessorNodeEx(&processor, &node) ? int(node) : 0;
+#elif defined(SYS_getcpu)
+	unsigned int cpu{};
+	unsigned int node{};
+	return syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 ? int(node) : 0;
+#else
+	return 0;
+#endif
+}
+
+void* SDBX::Memory::AcquireBackingMemory(size_t nbBytes, size_t alignment, const PageBacking& backing)
+{
+	if (backing.UsesHeap())
+		return ::operator new(nbBytes, std::align_val_t{ alignment }, std::nothrow);
+
+	SDBX_ASSERT_MSG(alignment <= VirtualMemory::GetPageSize(), "Page backed memory can't be aligned above the page size")
+
+	const size_t granularity{ GetMappingGranularity(backing) };
+	const size_t mappedSize{ AlignUp(nbBytes, granularity) };
+
+	void* pMemory{ MapPages(mappedSize, backing) };
+	if (!pMemory)
+		return nullptr;
+
+	ApplyPageBacking(pMemory, mappedSize, backing);
+
+	if (backing.firstTouch)
+		TouchPages(pMemory, mappedSize, VirtualMemory::GetPageSize());
+
+	return pMemory;
+}
+
+void SDBX::Memory::ReleaseBackingMemory(void* pMemory, size_t nbBytes, size_t alignment, const PageBacking& backing)
+{
+	if (!pMemory)
+		return;
+
+	if (backing.UsesHeap())
+	{
+		::operator delete(pMemory, std::align_val_t{ alignment });
+		return;
+	}
+
+#if defined(_WIN32)
+	(void)nbBytes;
+	VirtualFree(pMemory, 0, MEM_RELEASE);
+#else
+	munmap(pMemory, AlignUp(nbBytes, GetMappingGranularity(backing)));
+#endif
+}
+
+void SDBX::Memory::ApplyPageBacking([[maybe_unused]] void* pAddress, [[maybe_unused]] size_t nbBytes, [[maybe_unused]] const PageBacking& backing)
+{
+#if !defined(_WIN32)
+#if defined(MADV_HUGEPAGE)
+	if (backing.pageSize == PageBacking::PageSize::Huge)
+		madvise(pAddress, nbBytes, MADV_HUGEPAGE);
+#endif
+
+#if defined(SYS_mbind)
+	//MPOL_PREFERRED from numaif.h, spelled out to avoid depending on libnuma
+	static const int MPOL_PREFERRED_MODE{ 1 };
+
+	if (backing.numaNode != PageBacking::ANY_NODE)
+	{
+		SDBX_ASSERT_MSG(backing.numaNode >= 0 && backing.numaNode < int(sizeof(unsigned long) * 8), "NUMA node out of range")
+
+		const unsigned long nodeMask{ 1ul << backing.numaNode };
+		syscall(SYS_mbind, pAddress, nbBytes, MPOL_PREFERRED_MODE, &nodeMask, sizeof(nodeMask) * 8, 0);
+	}
+#endif
+#endif
+}
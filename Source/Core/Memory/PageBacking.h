@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+
+//Opt-in policy describing where the backing buffer of an allocator comes from.
+//The default policy keeps the plain heap, any other one maps whole pages straight from the system so it can ask for huge pages and a NUMA node.
+//Huge pages fall back to normal pages and NUMA placement is only a preference, so a policy never makes an allocation fail where the heap would succeed.
+namespace SDBX
+{
+	namespace Memory
+	{
+		struct PageBacking
+		{
+			enum class PageSize
+			{
+				Default,
+				// MAP_HUGETLB, then transparent huge pages (MADV_HUGEPAGE) on Linux, MEM_LARGE_PAGES on Windows
+				Huge
+			};
+
+			static const int ANY_NODE = -1;
+
+			PageSize pageSize{ PageSize::Default };
+			// Node the pages should preferably live on, ANY_NODE leaves it to the system
+			int numaNode{ ANY_NODE };
+			// Write every page from the acquiring thread, with the usual first touch policy this places them on that thread's node right away
+			bool firstTouch{ false };
+
+			bool UsesHeap() const { return pageSize == PageSize::Default && numaNode == ANY_NODE && !firstTouch; }
+
+			static PageBacking HugePages() { PageBacking backing{}; backing.pageSize = PageSize::Huge; return backing; }
+
+			// Pages on the node of the calling thread, meant to be created by the worker that will walk the memory
+			static PageBacking Local(PageSize pageSize = PageSize::Default);
+		};
+
+		// Node of the processor the calling thread runs on, 0 when the system can't tell
+		int GetCurrentNumaNode();
+
+		// Allocate a backing buffer following the policy, returns nullptr on failure.
+		// Page backed buffers are page aligned, alignment can't go above the page size.
+		void* AcquireBackingMemory(size_t nbBytes, size_t alignment, const PageBacking& backing);
+
+		// nbBytes, alignment and backing must match the AcquireBackingMemory call
+		void ReleaseBackingMemory(void* pMemory, size_t nbBytes, size_t alignment, const PageBacking& backing);
+
+		// Apply the huge page and NUMA hints to an already reserved range (see VirtualMemory), only supported on Linux
+		void ApplyPageBacking(void* pAddress, size_t nbBytes, const PageBacking& backing);
+	}
+}
@@ -0,0 +1,58 @@
+#include "VirtualMemory.h"
+
+#if defined(_WIN32)
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+size_t SDBX::Memory::VirtualMemory::GetPageSize()
+{
+#if defined(_WIN32)
+	static const size_t pageSize{ []() { SYSTEM_INFO info{}; GetSystemInfo(&info); return size_t(info.dwPageSize); }() };
+#else
+	static const size_t pageSize{ size_t(sysconf(_SC_PAGESIZE)) };
+#endif
+	return pageSize;
+}
+
+void* SDBX::Memory::VirtualMemory::Reserve(size_t nbBytes)
+{
+#if defined(_WIN32)
+	return VirtualAlloc(nullptr, nbBytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+	void* pAddress{ mmap(nullptr, nbBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0) };
+	return pAddress != MAP_FAILED ? pAddress : nullptr;
+#endif
+}
+
+bool SDBX::Memory::VirtualMemory::Commit(void* pAddress, size_t nbBytes)
+{
+#if defined(_WIN32)
+	return VirtualAlloc(pAddress, nbBytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+	return mprotect(pAddress, nbBytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+void SDBX::Memory::VirtualMemory::Decommit(void* pAddress, size_t nbBytes)
+{
+#if defined(_WIN32)
+	VirtualFree(pAddress, nbBytes, MEM_DECOMMIT);
+#else
+	//drop the pages first so they read back as zero, then make the range inaccessible again like a fresh reservation
+	madvise(pAddress, nbBytes, MADV_DONTNEED);
+	mprotect(pAddress, nbBytes, PROT_NONE);
+#endif
+}
+
+void SDBX::Memory::VirtualMemory::Release(void* pAddress, size_t nbBytes)
+{
+#if defined(_WIN32)
+	(void)nbBytes;
+	VirtualFree(pAddress, 0, MEM_RELEASE);
+#else
+	munmap(pAddress, nbBytes);
+#endif
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+//Thin wrapper over the OS page allocator: address space is reserved first and only costs physical memory once committed.
+//Every range given to Commit/Decommit must be page aligned and lie inside a range returned by Reserve.
+namespace SDBX
+{
+	namespace Memory
+	{
+		namespace VirtualMemory
+		{
+			size_t GetPageSize();
+
+			// Reserve address space without backing it, returns nullptr on failure
+			void* Reserve(size_t nbBytes);
+
+			// Back the pages with read/write memory, returns false when the system is out of memory
+			bool Commit(void* pAddress, size_t nbBytes);
+
+			// Give the physical pages back to the system, the range stays reserved and can be committed again
+			void Decommit(void* pAddress, size_t nbBytes);
+
+			// Release a complete reservation, pAddress and nbBytes must match a previous Reserve
+			void Release(void* pAddress, size_t nbBytes);
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace SDBX
+{
+	namespace Bit
+	{
+		// Index of the lowest set bit, value must not be 0
+		inline uint32_t FindFirstSet(uint64_t value)
+		{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			unsigned long idx{};
+			_BitScanForward64(&idx, value);
+			return static_cast<uint32_t>(idx);
+#elif defined(_MSC_VER)
+			unsigned long idx{};
+			if (_BitScanForward(&idx, static_cast<uint32_t>(value)))
+				return static_cast<uint32_t>(idx);
+
+			_BitScanForward(&idx, static_cast<uint32_t>(value >> 32));
+			return static_cast<uint32_t>(idx) + 32;
+#else
+			return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+		}
+
+		// Index of the highest set bit (floor(log2(value))), value must not be 0
+		inline uint32_t FindLastSet(uint64_t value)
+		{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			unsigned long idx{};
+			_BitScanReverse64(&idx, value);
+			return static_cast<uint32_t>(idx);
+#elif defined(_MSC_VER)
+			unsigned long idx{};
+			if (_BitScanReverse(&idx, static_cast<uint32_t>(value >> 32)))
+				return static_cast<uint32_t>(idx) + 32;
+
+			_BitScanReverse(&idx, static_cast<uint32_t>(value));
+			return static_cast<uint32_t>(idx);
+#else
+			return static_cast<uint32_t>(63 - __builtin_clzll(value));
+#endif
+		}
+
+		inline constexpr bool IsPowerOfTwo(uint64_t value) { return value && !(value & (value - 1)); }
+	}
+}
@@ -0,0 +1,266 @@
+#include "CallTree.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+
+#include "Core/Profiling/ProfileJson.h"
+
+SDBX::CallTree::CallTree(double millisecondsPerTick)
+	: m_Nodes()
+	, m_FrameCount(0)
+	, m_MillisecondsPerTick(millisecondsPerTick)
+{
+	m_Nodes.push_back(Node{ nullptr, NO_NODE, NO_NODE, NO_NODE, 0, 0, 0 });
+}
+
+uint32_t SDBX::CallTree::GetChild(uint32_t parent, const ProfileScope* pScope)
+{
+	//few children per node, a list walk beats a map here
+	uint32_t lastChild{ NO_NODE };
+	for (uint32_t child{ m_Nodes[parent].firstChild }; child != NO_NODE; child = m_Nodes[child].nextSibling)
+	{
+		if (m_Nodes[child].pScope->id == pScope->id)
+			return child;
+		lastChild = child;
+	}
+
+	const uint32_t node{ uint32_t(m_Nodes.size()) };
+	m_Nodes.push_back(Node{ pScope, parent, NO_NODE, NO_NODE, 0, 0, 0 });
+
+	//appended so children keep their first call order
+	if (lastChild != NO_NODE)
+		m_Nodes[lastChild].nextSibling = node;
+	else
+		m_Nodes[parent].firstChild = node;
+
+	return node;
+}
+
+void SDBX::CallTree::AddCall(uint32_t node, int64_t ticks)
+{
+	Node& callNode{ m_Nodes[node] };
+	++callNode.callCount;
+	callNode.inclusiveTicks += ticks;
+	m_Nodes[callNode.parent].childrenTicks += ticks;
+}
+
+void SDBX::CallTree::Merge(const CallTree& other)
+{
+	//a node always comes after its parent, so the parent is mapped first
+	std::vector<uint32_t> mappedNodes(other.m_Nodes.size(), ROOT);
+	for (uint32_t otherNode{ 1 }; otherNode < uint32_t(other.m_Nodes.size()); ++otherNode)
+	{
+		const Node& source{ other.m_Nodes[otherNode] };
+		const uint32_t node{ GetChild(mappedNodes[source.parent], source.pScope) };
+		mappedNodes[otherNode] = node;
+
+		m_Nodes[node].callCount += source.callCount;
+		m_Nodes[node].inclusiveTicks += source.inclusiveTicks;
+		m_Nodes[node].childrenTicks += source.childrenTicks;
+	}
+
+	m_Nodes[ROOT].childrenTicks += other.m_Nodes[ROOT].childrenTicks;
+	m_FrameCount += other.m_FrameCount;
+}
+
+void SDBX::CallTree::ResetValues()
+{
+	for (Node& node : m_Nodes)
+	{
+		node.callCount = 0;
+		node.inclusiveTicks = 0;
+		node.childrenTicks = 0;
+	}
+	m_FrameCount = 0;
+}
+
+void SDBX::CallTree::WriteText(std::ostream& stream) const
+{
+	stream.setf(std::ios::fixed, std::ios::floatfield);
+	stream.precision(3);
+
+	stream << "Call tree over " << m_FrameCount << " frame(s), times in ms per frame\n";
+	for (uint32_t child : GetSortedChildren(ROOT))
+		WriteTextNode(stream, child, 0);
+}
+
+void SDBX::CallTree::WriteJson(std::ostream& stream) const
+{
+	stream.setf(std::ios::fixed, std::ios::floatfield);
+	stream.precision(6);
+
+	stream << "{\"frameCount\":" << m_FrameCount << ",\"children\":[";
+	const char* pSeparator{ "" };
+	for (uint32_t child : GetSortedChildren(ROOT))
+	{
+		stream << pSeparator;
+		WriteJsonNode(stream, child);
+		pSeparator = ",";
+	}
+	stream << "]}\n";
+}
+
+void SDBX::CallTree::WriteTopScopes(std::ostream& stream, uint32_t count) const
+{
+	struct TopScope
+	{
+		const ProfileScope* pScope;
+		uint64_t callCount;
+		int64_t selfTicks;
+	};
+
+	std::unordered_map<uint64_t, TopScope> scopesById{};
+	for (uint32_t node{ 1 }; node < uint32_t(m_Nodes.size()); ++node)
+	{
+		const Node& scopeNode{ m_Nodes[node] };
+		TopScope& topScope{ scopesById.try_emplace(scopeNode.pScope->id, TopScope{ scopeNode.pScope, 0, 0 }).first->second };
+		topScope.callCount += scopeNode.callCount;
+		topScope.selfTicks += scopeNode.GetSelfTicks();
+	}
+
+	std::vector<TopScope> topScopes{};
+	for (const auto& [scopeId, topScope] : scopesById)
+	{
+		if (topScope.callCount > 0)
+			topScopes.push_back(topScope);
+	}
+
+	std::sort(std::begin(topScopes), std::end(topScopes), [](const TopScope& lhs, const TopScope& rhs) { return lhs.selfTicks > rhs.selfTicks; });
+	topScopes.resize(std::min(topScopes.size(), size_t(count)));
+
+	stream.setf(std::ios::fixed, std::ios::floatfield);
+	stream.precision(3);
+
+	stream << "Top scopes by self time, times in ms per frame\n";
+	for (const TopScope& topScope : topScopes)
+	{
+		stream << "self " << ToMilliseconds(topScope.selfTicks) << "  calls " << topScope.callCount << "  " << topScope.pScope->fncName
+			<< " (" << topScope.pScope->fileName << ":" << topScope.pScope->line << ")\n";
+	}
+}
+
+void SDBX::CallTree::WriteDiff(std::ostream& stream, const CallTree& before, const CallTree& after)
+{
+	struct Row
+	{
+		std::string path;
+		double beforeSelf;
+		double afterSelf;
+		double beforeInclusive;
+		double afterInclusive;
+	};
+
+	auto getPath{ [](const CallTree& tree, uint32_t node)
+	{
+		std::string path{};
+		for (uint32_t pathNode{ node }; pathNode != ROOT; pathNode = tree.m_Nodes[pathNode].parent)
+			path = std::string(tree.m_Nodes[pathNode].pScope->fncName) + (path.empty() ? "" : " > ") + path;
+		return path;
+	} };
+
+	std::vector<Row> rows{};
+	for (uint32_t afterNode{ 1 }; afterNode < uint32_t(after.m_Nodes.size()); ++afterNode)
+	{
+		const Node& node{ after.m_Nodes[afterNode] };
+		Row row{ getPath(after, afterNode), 0.0, after.ToMilliseconds(node.GetSelfTicks()), 0.0, after.ToMilliseconds(node.inclusiveTicks) };
+		uint64_t callCount{ node.callCount };
+
+		const uint32_t beforeNode{ before.FindPath(after, afterNode) };
+		if (beforeNode != NO_NODE)
+		{
+			row.beforeSelf = before.ToMilliseconds(before.m_Nodes[beforeNode].GetSelfTicks());
+			row.beforeInclusive = before.ToMilliseconds(before.m_Nodes[beforeNode].inclusiveTicks);
+			callCount += before.m_Nodes[beforeNode].callCount;
+		}
+
+		//nodes are kept after their path stops being called
+		if (callCount > 0)
+			rows.push_back(row);
+	}
+
+	//paths that disappeared
+	for (uint32_t beforeNode{ 1 }; beforeNode < uint32_t(before.m_Nodes.size()); ++beforeNode)
+	{
+		const Node& node{ before.m_Nodes[beforeNode] };
+		if (node.callCount == 0 || after.FindPath(before, beforeNode) != NO_NODE)
+			continue;
+
+		rows.push_back(Row{ getPath(before, beforeNode), before.ToMilliseconds(node.GetSelfTicks()), 0.0, before.ToMilliseconds(node.inclusiveTicks), 0.0 });
+	}
+
+	std::sort(std::begin(rows), std::end(rows), [](const Row& lhs, const Row& rhs) { return std::abs(lhs.afterSelf - lhs.beforeSelf) > std::abs(rhs.afterSelf - rhs.beforeSelf); });
+
+	stream.setf(std::ios::fixed, std::ios::floatfield);
+	stream.precision(3);
+
+	stream << "Call tree diff, times in ms per frame (before -> after)\n";
+	for (const Row& row : rows)
+	{
+		stream << (row.afterSelf >= row.beforeSelf ? "+" : "") << row.afterSelf - row.beforeSelf << " self: " << row.beforeSelf << " -> " << row.afterSelf
+			<< ", inclusive: " << row.beforeInclusive << " -> " << row.afterInclusive << "  " << row.path << "\n";
+	}
+}
+
+std::vector<uint32_t> SDBX::CallTree::GetSortedChildren(uint32_t node) const
+{
+	std::vector<uint32_t> children{};
+	for (uint32_t child{ m_Nodes[node].firstChild }; child != NO_NODE; child = m_Nodes[child].nextSibling)
+	{
+		//paths that existed in earlier frames but were not called in these ones
+		if (m_Nodes[child].callCount > 0)
+			children.push_back(child);
+	}
+
+	std::sort(std::begin(children), std::end(children), [this](uint32_t lhs, uint32_t rhs) { return m_Nodes[lhs].inclusiveTicks > m_Nodes[rhs].inclusiveTicks; });
+	return children;
+}
+
+void SDBX::CallTree::WriteTextNode(std::ostream& stream, uint32_t node, uint32_t depth) const
+{
+	const Node& textNode{ m_Nodes[node] };
+	stream << std::string(depth * 2, ' ') << textNode.pScope->fncName << " (" << textNode.pScope->fileName << ":" << textNode.pScope->line << ")"
+		<< "  inclusive " << ToMilliseconds(textNode.inclusiveTicks) << "  self " << ToMilliseconds(textNode.GetSelfTicks()) << "  calls " << textNode.callCount << "\n";
+
+	for (uint32_t child : GetSortedChildren(node))
+		WriteTextNode(stream, child, depth + 1);
+}
+
+void SDBX::CallTree::WriteJsonNode(std::ostream& stream, uint32_t node) const
+{
+	const Node& jsonNode{ m_Nodes[node] };
+	stream << "{\"name\":";
+	WriteJsonString(stream, jsonNode.pScope->fncName);
+	stream << ",\"file\":";
+	WriteJsonString(stream, jsonNode.pScope->fileName);
+	stream << ",\"line\":" << jsonNode.pScope->line << ",\"id\":" << jsonNode.pScope->id << ",\"calls\":" << jsonNode.callCount
+		<< ",\"inclusiveMs\":" << ToMilliseconds(jsonNode.inclusiveTicks) << ",\"selfMs\":" << ToMilliseconds(jsonNode.GetSelfTicks()) << ",\"children\":[";
+
+	const char* pSeparator{ "" };
+	for (uint32_t child : GetSortedChildren(node))
+	{
+		stream << pSeparator;
+		WriteJsonNode(stream, child);
+		pSeparator = ",";
+	}
+	stream << "]}";
+}
+
+uint32_t SDBX::CallTree::FindPath(const CallTree& other, uint32_t otherNode) const
+{
+	std::vector<uint64_t> path{};
+	for (uint32_t pathNode{ otherNode }; pathNode != ROOT; pathNode = other.m_Nodes[pathNode].parent)
+		path.push_back(other.m_Nodes[pathNode].pScope->id);
+
+	uint32_t node{ ROOT };
+	for (auto it{ path.rbegin() }; it != path.rend() && node != NO_NODE; ++it)
+	{
+		uint32_t child{ m_Nodes[node].firstChild };
+		while (child != NO_NODE && m_Nodes[child].pScope->id != *it)
+			child = m_Nodes[child].nextSibling;
+		node = child;
+	}
+
+	return node;
+}
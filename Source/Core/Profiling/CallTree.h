@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "Core/Profiling/ProfileScope.h"
+
+//Profiler scopes aggregated on their call path: a scope called from two different parents gets two nodes.
+//Paths are merged across threads, a job run on any worker ends up in the same node.
+//Times are kept in clock ticks and reported in milliseconds per frame.
+namespace SDBX
+{
+	class CallTree final
+	{
+	public:
+		static constexpr uint32_t ROOT{ 0 };
+		static constexpr uint32_t NO_NODE{ UINT32_MAX };
+
+		struct Node
+		{
+			const ProfileScope* pScope;
+			uint32_t parent;
+			uint32_t firstChild;
+			uint32_t nextSibling;
+			uint64_t callCount;
+			int64_t inclusiveTicks;
+			// Inclusive time of the children, self time is what is left
+			int64_t childrenTicks;
+
+			int64_t GetSelfTicks() const { return inclusiveTicks - childrenTicks; }
+		};
+
+		explicit CallTree(double millisecondsPerTick = 0.0);
+
+		// Child of parent for the scope, added on first call
+		uint32_t GetChild(uint32_t parent, const ProfileScope* pScope);
+		void AddCall(uint32_t node, int64_t ticks);
+
+		void AddFrames(uint32_t frameCount) { m_FrameCount += frameCount; }
+		// Add the times of other along the same paths, the nodes of other that don't exist yet are added
+		void Merge(const CallTree& other);
+		// Zero every time and count but keep the nodes, indices stay valid
+		void ResetValues();
+
+		const std::vector<Node>& GetNodes() const { return m_Nodes; }
+		uint32_t GetFrameCount() const { return m_FrameCount; }
+		// Per frame average when frames were recorded
+		double ToMilliseconds(int64_t ticks) const { return double(ticks) * m_MillisecondsPerTick / double(m_FrameCount > 0 ? m_FrameCount : 1); }
+
+		// Indented tree, children sorted on inclusive time
+		void WriteText(std::ostream& stream) const;
+		void WriteJson(std::ostream& stream) const;
+		// The scopes with the most self time summed over all their paths, at most count of them
+		void WriteTopScopes(std::ostream& stream, uint32_t count) const;
+
+		// Every path found in either tree with its per frame self and inclusive time in both, sorted on the largest self time change
+		static void WriteDiff(std::ostream& stream, const CallTree& before, const CallTree& after);
+
+	private:
+		std::vector<uint32_t> GetSortedChildren(uint32_t node) const;
+		void WriteTextNode(std::ostream& stream, uint32_t node, uint32_t depth) const;
+		void WriteJsonNode(std::ostream& stream, uint32_t node) const;
+		//node of other's path in this tree, NO_NODE when the path doesn't exist
+		uint32_t FindPath(const CallTree& other, uint32_t otherNode) const;
+
+		std::vector<Node> m_Nodes;
+		uint32_t m_FrameCount;
+		double m_MillisecondsPerTick;
+	};
+}
@@ -0,0 +1,47 @@
+#include "ChromeTrace.h"
+
+#include "Core/Profiling/ProfileJson.h"
+
+void SDBX::WriteChromeTrace(std::ostream& stream, const ChromeTrace& trace)
+{
+	auto toMicroseconds{ [&trace](int64_t timestamp) { return double(timestamp - trace.startTimestamp) * trace.microsecondsPerTick; } };
+	const char* pSeparator{ "\n" };
+
+	//microseconds with a nanosecond resolution
+	stream.setf(std::ios::fixed, std::ios::floatfield);
+	stream.precision(3);
+
+	stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+	for (const auto& [threadId, threadName] : trace.threadNames)
+	{
+		stream << pSeparator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threadId << ",\"args\":{\"name\":";
+		WriteJsonString(stream, threadName.c_str());
+		stream << "}}";
+		pSeparator = ",\n";
+	}
+
+	for (const ChromeTrace::Frame& frame : trace.frames)
+	{
+		stream << pSeparator << "{\"name\":\"Frame " << frame.frameIndex << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":" << toMicroseconds(frame.timestamp) << "}";
+		pSeparator = ",\n";
+	}
+
+	for (const ChromeTrace::Scope& scope : trace.scopes)
+	{
+		auto descriptorIt{ trace.descriptors.find(scope.scopeId) };
+		if (descriptorIt == std::end(trace.descriptors))
+			continue;
+
+		const ProfileScope& descriptor{ *descriptorIt->second };
+		stream << pSeparator << "{\"name\":";
+		WriteJsonString(stream, descriptor.fncName);
+		stream << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << scope.threadId << ",\"ts\":" << toMicroseconds(scope.beginTimestamp)
+			<< ",\"dur\":" << double(scope.endTimestamp - scope.beginTimestamp) * trace.microsecondsPerTick << ",\"args\":{\"file\":";
+		WriteJsonString(stream, descriptor.fileName);
+		stream << ",\"line\":" << descriptor.line << "}}";
+		pSeparator = ",\n";
+	}
+
+	stream << "\n]}\n";
+}
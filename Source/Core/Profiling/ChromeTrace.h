@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/Profiling/ProfileScope.h"
+
+//Profiler capture in the Chrome Trace Event format, opens in chrome://tracing and ui.perfetto.dev.
+//Scopes are written as complete events (begin and duration) on their thread track, frames as global instant events.
+namespace SDBX
+{
+	struct ChromeTrace
+	{
+		struct Scope
+		{
+			uint64_t scopeId;
+			uint32_t threadId;
+			int64_t beginTimestamp;
+			int64_t endTimestamp;
+		};
+
+		struct Frame
+		{
+			uint64_t frameIndex;
+			int64_t timestamp;
+		};
+
+		std::vector<Scope> scopes;
+		std::vector<Frame> frames;
+		std::unordered_map<uint32_t, std::string> threadNames;
+		// Descriptors of every scope id found in scopes, they are statics so the pointers stay valid
+		std::unordered_map<uint64_t, const ProfileScope*> descriptors;
+		// Timestamps are written relative to the start of the capture
+		int64_t startTimestamp;
+		double microsecondsPerTick;
+	};
+
+	void WriteChromeTrace(std::ostream& stream, const ChromeTrace& trace);
+}
@@ -0,0 +1,100 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Core/Misc/Bit/BitUtils.h"
+
+SDBX::LatencyHistogram::LatencyHistogram()
+	: m_Buckets()
+	, m_Count(0)
+	, m_Sum(0)
+	, m_Min(INT64_MAX)
+	, m_Max(0)
+{}
+
+void SDBX::LatencyHistogram::Record(int64_t ticks)
+{
+	//a clock going backwards between two cores
+	ticks = std::max<int64_t>(ticks, 0);
+
+	++m_Buckets[GetBucketIndex(ticks)];
+	++m_Count;
+	m_Sum += ticks;
+	m_Min = std::min(m_Min, ticks);
+	m_Max = std::max(m_Max, ticks);
+}
+
+void SDBX::LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+	for (uint32_t bucketIdx{}; bucketIdx < BUCKET_COUNT; ++bucketIdx)
+		m_Buckets[bucketIdx] += other.m_Buckets[bucketIdx];
+
+	m_Count += other.m_Count;
+	m_Sum += other.m_Sum;
+	m_Min = std::min(m_Min, other.m_Min);
+	m_Max = std::max(m_Max, other.m_Max);
+}
+
+void SDBX::LatencyHistogram::Reset()
+{
+	m_Buckets.fill(0);
+	m_Count = 0;
+	m_Sum = 0;
+	m_Min = INT64_MAX;
+	m_Max = 0;
+}
+
+int64_t SDBX::LatencyHistogram::GetPercentile(double percentile) const
+{
+	if (m_Count == 0)
+		return 0;
+
+	const uint64_t targetCount{ std::max<uint64_t>(uint64_t(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * double(m_Count))), 1) };
+
+	uint64_t count{};
+	for (uint32_t bucketIdx{}; bucketIdx < BUCKET_COUNT; ++bucketIdx)
+	{
+		count += m_Buckets[bucketIdx];
+		if (count >= targetCount)
+			return std::clamp(GetBucketUpperBound(bucketIdx), m_Min, m_Max);
+	}
+
+	return m_Max;
+}
+
+SDBX::LatencyStatistics SDBX::LatencyHistogram::GetStatistics(double millisecondsPerTick) const
+{
+	return LatencyStatistics{ m_Count
+		, double(GetMin()) * millisecondsPerTick
+		, double(GetMax()) * millisecondsPerTick
+		, GetMean() * millisecondsPerTick
+		, double(GetPercentile(50.0)) * millisecondsPerTick
+		, double(GetPercentile(95.0)) * millisecondsPerTick
+		, double(GetPercentile(99.0)) * millisecondsPerTick
+		, double(GetPercentile(99.9)) * millisecondsPerTick };
+}
+
+uint32_t SDBX::LatencyHistogram::GetBucketIndex(int64_t ticks)
+{
+	const uint64_t value{ uint64_t(ticks) };
+	if (value < 2 * SUB_BUCKET_COUNT)
+		return uint32_t(value);
+
+	//value >> shift keeps SUB_BUCKET_BITS + 1 bits, in [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT)
+	const uint32_t shift{ Bit::FindLastSet(value) - SUB_BUCKET_BITS };
+	return std::min(shift * SUB_BUCKET_COUNT + uint32_t(value >> shift), BUCKET_COUNT - 1);
+}
+
+int64_t SDBX::LatencyHistogram::GetBucketUpperBound(uint32_t bucketIdx)
+{
+	if (bucketIdx < 2 * SUB_BUCKET_COUNT)
+		return int64_t(bucketIdx);
+
+	if (bucketIdx == BUCKET_COUNT - 1)
+		return INT64_MAX;
+
+	const uint32_t shift{ bucketIdx / SUB_BUCKET_COUNT - 1 };
+	const uint64_t subBucket{ bucketIdx - shift * SUB_BUCKET_COUNT };
+	return int64_t(((subBucket + 1) << shift) - 1);
+}
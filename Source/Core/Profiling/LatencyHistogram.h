@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+//Log-linear histogram of durations in clock ticks, in the spirit of HdrHistogram.
+//Values below 2 * SUB_BUCKET_COUNT get one bucket each, every power of two above is split in SUB_BUCKET_COUNT buckets,
+//so a recorded value is known within 1 / SUB_BUCKET_COUNT of its size whatever its magnitude, in a fixed amount of memory.
+namespace SDBX
+{
+	struct LatencyStatistics
+	{
+		uint64_t count;
+		double min;
+		double max;
+		double mean;
+		double p50;
+		double p95;
+		double p99;
+		double p999;
+	};
+
+	class LatencyHistogram final
+	{
+	public:
+		static constexpr uint32_t SUB_BUCKET_BITS{ 5 };
+		static constexpr uint32_t SUB_BUCKET_COUNT{ 1u << SUB_BUCKET_BITS };
+		// Values from 2^MAX_VALUE_BITS ticks on share the last bucket, min and max stay exact
+		static constexpr uint32_t MAX_VALUE_BITS{ 40 };
+		static constexpr uint32_t BUCKET_COUNT{ (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT };
+
+		explicit LatencyHistogram();
+
+		void Record(int64_t ticks);
+		void Merge(const LatencyHistogram& other);
+		void Reset();
+
+		uint64_t GetCount() const { return m_Count; }
+		int64_t GetMin() const { return m_Count > 0 ? m_Min : 0; }
+		int64_t GetMax() const { return m_Max; }
+		double GetMean() const { return m_Count > 0 ? double(m_Sum) / double(m_Count) : 0.0; }
+		// Smallest recorded bucket bound at or above percentile (0 - 100) of the values, clamped to [min, max]
+		int64_t GetPercentile(double percentile) const;
+
+		// Every statistic converted with millisecondsPerTick
+		LatencyStatistics GetStatistics(double millisecondsPerTick) const;
+
+	private:
+		static uint32_t GetBucketIndex(int64_t ticks);
+		//largest value that falls in the bucket
+		static int64_t GetBucketUpperBound(uint32_t bucketIdx);
+
+		std::array<uint32_t, BUCKET_COUNT> m_Buckets;
+		uint64_t m_Count;
+		int64_t m_Sum;
+		int64_t m_Min;
+		int64_t m_Max;
+	};
+}
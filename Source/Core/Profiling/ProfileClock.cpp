@@ -0,0 +1,75 @@
+#include "ProfileClock.h"
+
+#if SDBX_PROFILING_TSC_ENABLED && !defined(_MSC_VER)
+	#include <cpuid.h>
+#endif
+
+SDBX::ProfileClockSource SDBX::ProfileClock::s_Source{ ProfileClockSource::SteadyClock };
+double SDBX::ProfileClock::s_MicrosecondsPerTick{ double(std::chrono::steady_clock::period::num) * 1000000.0 / double(std::chrono::steady_clock::period::den) };
+
+SDBX::ProfileClockSource SDBX::ProfileClock::Initialize(ProfileClockSource preferredSource)
+{
+	s_Source = ProfileClockSource::SteadyClock;
+	s_MicrosecondsPerTick = double(std::chrono::steady_clock::period::num) * 1000000.0 / double(std::chrono::steady_clock::period::den);
+
+	if (preferredSource == ProfileClockSource::Tsc && IsTscInvariant())
+	{
+		const double microsecondsPerTick{ CalibrateTsc() };
+		if (microsecondsPerTick > 0.0)
+		{
+			s_Source = ProfileClockSource::Tsc;
+			s_MicrosecondsPerTick = microsecondsPerTick;
+		}
+	}
+
+	return s_Source;
+}
+
+bool SDBX::ProfileClock::IsTscInvariant()
+{
+#if SDBX_PROFILING_TSC_ENABLED
+	//CPUID.80000007H:EDX[8], the same bit on Intel and AMD
+	const unsigned int INVARIANT_TSC_BIT{ 1u << 8 };
+
+	#if defined(_MSC_VER)
+	int registers[4]{};
+	__cpuid(registers, 0x80000000);
+	if (static_cast<unsigned int>(registers[0]) < 0x80000007)
+		return false;
+
+	__cpuid(registers, 0x80000007);
+	return (static_cast<unsigned int>(registers[3]) & INVARIANT_TSC_BIT) != 0;
+	#else
+	unsigned int eax{}, ebx{}, ecx{}, edx{};
+	if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007 || !__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+		return false;
+
+	return (edx & INVARIANT_TSC_BIT) != 0;
+	#endif
+#else
+	return false;
+#endif
+}
+
+double SDBX::ProfileClock::CalibrateTsc()
+{
+#if SDBX_PROFILING_TSC_ENABLED
+	//rdtscp waits for the previous instructions so the two clocks are read as close as possible
+	unsigned int processorId{};
+	const auto steadyStart{ std::chrono::steady_clock::now() };
+	const uint64_t tscStart{ __rdtscp(&processorId) };
+
+	//spin rather than sleep, a sleep can overshoot by a whole scheduler tick
+	while (std::chrono::steady_clock::now() - steadyStart < CALIBRATION_DURATION) {}
+
+	const uint64_t tscEnd{ __rdtscp(&processorId) };
+	const auto steadyEnd{ std::chrono::steady_clock::now() };
+
+	if (tscEnd <= tscStart)
+		return 0.0;
+
+	return std::chrono::duration<double, std::micro>(steadyEnd - steadyStart).count() / double(tscEnd - tscStart);
+#else
+	return 0.0;
+#endif
+}
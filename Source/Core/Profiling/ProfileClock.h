@@ -0,0 +1,64 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+#if !defined(SDBX_PROFILING_STEADY_CLOCK) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+	#define SDBX_PROFILING_TSC_ENABLED 1
+#else
+	#define SDBX_PROFILING_TSC_ENABLED 0
+#endif
+
+#if SDBX_PROFILING_TSC_ENABLED
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+#endif
+
+//Clock of the profiler timestamps. Reading the time stamp counter is a single instruction where steady_clock goes through the OS,
+//so the TSC is used whenever the CPU reports it as invariant (constant rate across frequency changes and sleep states, synchronized between cores).
+//Its rate is calibrated against steady_clock on Initialize. Define SDBX_PROFILING_STEADY_CLOCK to always use steady_clock.
+namespace SDBX
+{
+	enum class ProfileClockSource : uint8_t
+	{
+		SteadyClock
+		, Tsc
+	};
+
+	class ProfileClock final
+	{
+	public:
+		static constexpr ProfileClockSource DEFAULT_SOURCE{ SDBX_PROFILING_TSC_ENABLED ? ProfileClockSource::Tsc : ProfileClockSource::SteadyClock };
+		// Time spent measuring the TSC rate
+		static constexpr std::chrono::milliseconds CALIBRATION_DURATION{ 20 };
+
+		// Must be called before the first Now, Tsc falls back to SteadyClock when the TSC is not invariant. Returns the source in use
+		static ProfileClockSource Initialize(ProfileClockSource preferredSource);
+
+		static inline int64_t Now();
+
+		static ProfileClockSource GetSource() { return s_Source; }
+		static double GetMicrosecondsPerTick() { return s_MicrosecondsPerTick; }
+
+		static bool IsTscInvariant();
+
+	private:
+		static double CalibrateTsc();
+
+		static ProfileClockSource s_Source;
+		static double s_MicrosecondsPerTick;
+	};
+}
+
+int64_t SDBX::ProfileClock::Now()
+{
+#if SDBX_PROFILING_TSC_ENABLED
+	//rdtsc doesn't wait for the previous instructions, scopes are long enough for it not to matter and it is cheaper than rdtscp
+	if (s_Source == ProfileClockSource::Tsc)
+		return int64_t(__rdtsc());
+#endif
+
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+}
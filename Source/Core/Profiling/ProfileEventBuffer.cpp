@@ -0,0 +1,26 @@
+#include "ProfileEventBuffer.h"
+
+#include "Core/Log/Logger.h"
+#include "Core/Misc/Bit/BitUtils.h"
+
+namespace
+{
+	size_t RoundUpToPowerOfTwo(size_t value)
+	{
+		return value > 1 ? size_t(1) << (SDBX::Bit::FindLastSet(value - 1) + 1) : 1;
+	}
+}
+
+SDBX::ProfileEventBuffer::ProfileEventBuffer(size_t capacity)
+	: m_Events(RoundUpToPowerOfTwo(capacity))
+	, m_Mask(m_Events.size() - 1)
+	, m_Head(0)
+	, m_CachedTail(0)
+	, m_OpenScopes(0)
+	, m_DroppedDepth(0)
+	, m_DroppedCount(0)
+	, m_Tail(0)
+	, m_IsRetired(false)
+{
+	SDBX_ASSERT_MSG(capacity >= 2, "The buffer must hold at least one begin and its end")
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SDBX
+{
+	enum class ProfileEventType : uint8_t
+	{
+		Begin
+		, End
+		, Frame
+	};
+
+	struct ProfileEvent
+	{
+		int64_t timestamp;
+		// 0 for End events, they close the last open scope of the thread. Frame index for Frame events
+		uint64_t scopeId;
+		ProfileEventType type;
+	};
+
+	//Ring of profile events written by one thread and read by the profiler collector, without locks.
+	//The writer never waits: when the ring is full the Begin event is dropped, and its End with it.
+	//Scopes opened inside a dropped one are dropped as well, and room is always kept for the End of every recorded Begin, so scopes never come out unbalanced.
+	class ProfileEventBuffer final
+	{
+	public:
+		static const size_t DEFAULT_CAPACITY = 16 * 1024;
+
+		// Capacity is rounded up to a power of two
+		explicit ProfileEventBuffer(size_t capacity = DEFAULT_CAPACITY);
+		~ProfileEventBuffer() = default;
+		ProfileEventBuffer(const ProfileEventBuffer& other) = delete;
+		ProfileEventBuffer(ProfileEventBuffer&& other) noexcept = delete;
+		ProfileEventBuffer& operator=(const ProfileEventBuffer& other) = delete;
+		ProfileEventBuffer& operator=(ProfileEventBuffer&& other) noexcept = delete;
+
+		// Writer thread only, returns false when the event is dropped
+		inline bool PushBegin(int64_t timestamp, uint64_t scopeId);
+		// Writer thread only, skipped when the matching Begin was dropped
+		inline void PushEnd(int64_t timestamp);
+		// Writer thread only, returns false when the event is dropped
+		inline bool PushFrame(int64_t timestamp, uint64_t frameIndex);
+
+		// Reader thread only, calls consumer(const ProfileEvent&) for every pending event in write order
+		template<typename Consumer>
+		size_t Drain(Consumer&& consumer);
+
+		size_t GetDroppedCount() const { return m_DroppedCount.load(std::memory_order_relaxed); }
+
+		// Called when the writer thread ends, the reader can free the buffer once it is drained
+		void Retire() { m_IsRetired.store(true, std::memory_order_release); }
+		bool IsRetired() const { return m_IsRetired.load(std::memory_order_acquire); }
+
+	private:
+		//keeps room for the End of every open scope
+		inline bool HasRoom(size_t eventCount);
+		inline void Push(const ProfileEvent& event);
+
+		std::vector<ProfileEvent> m_Events;
+		size_t m_Mask;
+
+		//writer side, m_CachedTail avoids reading the reader cache line on every push
+		alignas(64) std::atomic<size_t> m_Head;
+		size_t m_CachedTail;
+		size_t m_OpenScopes;
+		//scopes opened since the first dropped Begin still open
+		size_t m_DroppedDepth;
+		std::atomic<size_t> m_DroppedCount;
+
+		alignas(64) std::atomic<size_t> m_Tail;
+		std::atomic<bool> m_IsRetired;
+	};
+}
+
+bool SDBX::ProfileEventBuffer::PushBegin(int64_t timestamp, uint64_t scopeId)
+{
+	if (m_DroppedDepth > 0)
+	{
+		++m_DroppedDepth;
+		return false;
+	}
+
+	//the begin and its end
+	if (!HasRoom(2))
+	{
+		m_DroppedDepth = 1;
+		return false;
+	}
+
+	++m_OpenScopes;
+	Push(ProfileEvent{ timestamp, scopeId, ProfileEventType::Begin });
+	return true;
+}
+
+void SDBX::ProfileEventBuffer::PushEnd(int64_t timestamp)
+{
+	if (m_DroppedDepth > 0)
+	{
+		--m_DroppedDepth;
+		return;
+	}
+
+	//the room was reserved by PushBegin
+	--m_OpenScopes;
+	Push(ProfileEvent{ timestamp, 0, ProfileEventType::End });
+}
+
+bool SDBX::ProfileEventBuffer::PushFrame(int64_t timestamp, uint64_t frameIndex)
+{
+	if (!HasRoom(1))
+		return false;
+
+	Push(ProfileEvent{ timestamp, frameIndex, ProfileEventType::Frame });
+	return true;
+}
+
+bool SDBX::ProfileEventBuffer::HasRoom(size_t eventCount)
+{
+	const size_t head{ m_Head.load(std::memory_order_relaxed) };
+	const size_t requiredCount{ m_OpenScopes + eventCount };
+	if (head - m_CachedTail + requiredCount <= m_Events.size())
+		return true;
+
+	m_CachedTail = m_Tail.load(std::memory_order_acquire);
+	if (head - m_CachedTail + requiredCount <= m_Events.size())
+		return true;
+
+	m_DroppedCount.store(m_DroppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	return false;
+}
+
+void SDBX::ProfileEventBuffer::Push(const ProfileEvent& event)
+{
+	const size_t head{ m_Head.load(std::memory_order_relaxed) };
+	m_Events[head & m_Mask] = event;
+	m_Head.store(head + 1, std::memory_order_release);
+}
+
+template<typename Consumer>
+size_t SDBX::ProfileEventBuffer::Drain(Consumer&& consumer)
+{
+	const size_t head{ m_Head.load(std::memory_order_acquire) };
+	const size_t tail{ m_Tail.load(std::memory_order_relaxed) };
+
+	for (size_t idx{ tail }; idx != head; ++idx)
+		consumer(static_cast<const ProfileEvent&>(m_Events[idx & m_Mask]));
+
+	m_Tail.store(head, std::memory_order_release);
+	return head - tail;
+}
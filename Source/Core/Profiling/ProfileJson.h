@@ -0,0 +1,24 @@
+#pragma once
+#include <ostream>
+
+namespace SDBX
+{
+	// Write pString quoted, with the characters JSON doesn't allow in a string escaped (Windows paths are full of backslashes)
+	inline void WriteJsonString(std::ostream& stream, const char* pString)
+	{
+		static const char HEX_DIGITS[]{ "0123456789abcdef" };
+
+		stream << '"';
+		for (const char* pChar{ pString }; *pChar != '\0'; ++pChar)
+		{
+			const unsigned char character{ static_cast<unsigned char>(*pChar) };
+			if (character == '"' || character == '\\')
+				stream << '\\' << *pChar;
+			else if (character < 0x20)
+				stream << "\\u00" << HEX_DIGITS[character >> 4] << HEX_DIGITS[character & 0xF];
+			else
+				stream << *pChar;
+		}
+		stream << '"';
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+namespace SDBX
+{
+	// FNV-1a over the file name then the line, computed at compile time at every profiling macro.
+	// Only depends on the source location so the same scope keeps its id from one run to the next
+	constexpr uint64_t HashProfileScope(const char* fileName, uint32_t line)
+	{
+		const uint64_t FNV_OFFSET_BASIS{ 14695981039346656037ull };
+		const uint64_t FNV_PRIME{ 1099511628211ull };
+
+		uint64_t hash{ FNV_OFFSET_BASIS };
+		for (const char* pChar{ fileName }; *pChar != '\0'; ++pChar)
+		{
+			hash ^= uint64_t(uint8_t(*pChar));
+			hash *= FNV_PRIME;
+		}
+
+		for (uint32_t byteIdx{}; byteIdx < sizeof(line); ++byteIdx)
+		{
+			hash ^= uint64_t((line >> (byteIdx * 8)) & 0xFF);
+			hash *= FNV_PRIME;
+		}
+
+		return hash;
+	}
+
+	// Static description of an instrumented scope, one per macro site.
+	// Only the id goes through the event buffers, the profiler looks the rest up when it aggregates
+	struct ProfileScope
+	{
+		uint64_t id;
+		const char* fileName;
+		const char* fncName;
+		uint32_t line;
+		// Number of calls gathered in the latency histogram before its statistics are logged
+		uint32_t frameCount;
+	};
+}
@@ -1,52 +1,426 @@
 #include "Profiler.h"
 
-size_t SDBX::Profiler::StartTimer(const std::string& fileName, const std::string& fncName, uint32_t frameCount)
+#include <algorithm>
+#include <fstream>
+
+thread_local SDBX::Profiler::ThreadEventsHolder SDBX::Profiler::s_ThreadEvents{};
+
+SDBX::Profiler::ThreadEventsHolder::~ThreadEventsHolder()
+{
+	if (pThreadEvents)
+		pThreadEvents->buffer.Retire();
+}
+
+SDBX::Profiler::Profiler()
+	: m_ClockSource(ProfileClock::Initialize(ProfileClock::DEFAULT_SOURCE))
+	, m_ThreadsMutex()
+	, m_Threads()
+	, m_NextThreadId(1)
+	, m_TimersMutex()
+	, m_Timers()
+	, m_CollectMutex()
+	, m_CollectCondition()
+	, m_IsStopping(false)
+	, m_CollectorThread()
+	, m_FrameIndex(0)
+	, m_FrameCallTree(GetMicrosecondsPerTick() / 1000.0)
+	, m_LastFrameCallTree(GetMicrosecondsPerTick() / 1000.0)
+	, m_LastCaptureCallTree(GetMicrosecondsPerTick() / 1000.0)
+	, m_Capture()
+	, m_SpikeRecorder()
+	, m_IsCapturing(false)
+	, m_WriteMutex()
+	, m_WriteCondition()
+	, m_WriteQueue()
+	, m_IsWriterStopping(false)
+	, m_WriterThread()
+{
+	SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::INFO_LOG, m_ClockSource == ProfileClockSource::Tsc
+		? "Profiling Clock: invariant TSC at " + std::to_string(1.0 / GetMicrosecondsPerTick()) + "MHz"
+		: std::string("Profiling Clock: steady_clock"));
+
+	m_WriterThread = std::thread{ &Profiler::WriterLoop, this };
+	m_CollectorThread = std::thread{ &Profiler::CollectorLoop, this };
+}
+
+SDBX::Profiler::~Profiler()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_CollectMutex };
+		m_IsStopping = true;
+	}
+	m_CollectCondition.notify_one();
+	m_CollectorThread.join();
+
+	StopCapture();
+	Flush();
+
+	//the queued files are written before the thread ends
+	{
+		std::lock_guard<std::mutex> lock{ m_WriteMutex };
+		m_IsWriterStopping = true;
+	}
+	m_WriteCondition.notify_one();
+	m_WriterThread.join();
+}
+
+void SDBX::Profiler::RegisterScope(const ProfileScope& scope)
+{
+	std::lock_guard<std::mutex> lock{ m_TimersMutex };
+	const auto [timerIt, isInserted] { m_Timers.try_emplace(scope.id, Timer{ &scope, LatencyHistogram{} }) };
+	SDBX_ASSERT_MSG(isInserted || timerIt->second.pScope->line == scope.line, "Two profiling scopes share the same id")
+}
+
+void SDBX::Profiler::Flush()
+{
+	std::lock_guard<std::mutex> lock{ m_CollectMutex };
+	Collect();
+}
+
+void SDBX::Profiler::SetThreadName(const std::string& name)
+{
+	ThreadEvents& threadEvents{ GetThreadEvents() };
+
+	std::lock_guard<std::mutex> lock{ m_ThreadsMutex };
+	threadEvents.name = name;
+}
+
+void SDBX::Profiler::StartCapture(const std::string& filePath)
+{
+	std::lock_guard<std::mutex> lock{ m_CollectMutex };
+	SDBX_ASSERT_MSG(m_Capture.state == CaptureState::Idle, "A capture is already running")
+
+	//events recorded before the capture don't belong to it
+	Collect();
+
+	m_Capture = Capture{ CaptureState::Running, filePath, 0, 0, INT64_MAX, ChromeTrace{}, CallTree{ GetMicrosecondsPerTick() / 1000.0 } };
+	m_Capture.trace.startTimestamp = GetTimestamp();
+	m_Capture.trace.microsecondsPerTick = GetMicrosecondsPerTick();
+	m_IsCapturing.store(true, std::memory_order_relaxed);
+}
+
+void SDBX::Profiler::CaptureFrames(const std::string& filePath, uint32_t frameCount)
+{
+	SDBX_ASSERT_MSG(frameCount > 0, "A capture needs at least one frame")
+
+	std::lock_guard<std::mutex> lock{ m_CollectMutex };
+	SDBX_ASSERT_MSG(m_Capture.state == CaptureState::Idle, "A capture is already running")
+
+	//the start is only known once the next frame is drained, scopes are kept until then and trimmed when written
+	m_Capture = Capture{ CaptureState::Pending, filePath, frameCount, 0, INT64_MAX, ChromeTrace{}, CallTree{ GetMicrosecondsPerTick() / 1000.0 } };
+	m_Capture.trace.startTimestamp = 0;
+	m_Capture.trace.microsecondsPerTick = GetMicrosecondsPerTick();
+	m_IsCapturing.store(true, std::memory_order_relaxed);
+}
+
+void SDBX::Profiler::StopCapture()
+{
+	std::lock_guard<std::mutex> lock{ m_CollectMutex };
+	if (m_Capture.state == CaptureState::Pending)
+	{
+		m_Capture = Capture{ CaptureState::Idle, std::string{}, 0, 0, INT64_MAX, ChromeTrace{}, CallTree{} };
+		m_IsCapturing.store(false, std::memory_order_relaxed);
+		return;
+	}
+
+	if (m_Capture.state != CaptureState::Running)
+		return;
+
+	m_Capture.endTimestamp = GetTimestamp();
+	m_Capture.state = CaptureState::Finishing;
+	Collect();
+}
+
+void SDBX::Profiler::EnableSpikeCapture(const SpikeRecorder::Settings& settings)
+{
+	std::lock_guard<std::mutex> lock{ m_CollectMutex };
+	m_SpikeRecorder.Enable(settings, GetMicrosecondsPerTick());
+}
+
+void SDBX::Profiler::DisableSpikeCapture()
+{
+	std::lock_guard<std::mutex> lock{ m_CollectMutex };
+	m_SpikeRecorder.Disable();
+}
+
+SDBX::CallTree SDBX::Profiler::GetLastFrameCallTree()
+{
+	std::lock_guard<std::mutex> lock{ m_CollectMutex };
+	return m_LastFrameCallTree;
+}
+
+SDBX::CallTree SDBX::Profiler::GetLastCaptureCallTree()
+{
+	std::lock_guard<std::mutex> lock{ m_CollectMutex };
+	return m_LastCaptureCallTree;
+}
+
+SDBX::Profiler::ThreadEvents& SDBX::Profiler::AddThreadEvents()
+{
+	std::lock_guard<std::mutex> lock{ m_ThreadsMutex };
+	m_Threads.push_back(std::make_unique<ThreadEvents>());
+	m_Threads.back()->threadId = m_NextThreadId++;
+	s_ThreadEvents.pThreadEvents = m_Threads.back().get();
+	return *s_ThreadEvents.pThreadEvents;
+}
+
+void SDBX::Profiler::CollectorLoop()
+{
+	std::unique_lock<std::mutex> lock{ m_CollectMutex };
+	while (!m_IsStopping)
+	{
+		m_CollectCondition.wait_for(lock, COLLECT_PERIOD);
+		Collect();
+	}
+}
+
+void SDBX::Profiler::Collect()
+{
+	std::lock_guard<std::mutex> threadsLock{ m_ThreadsMutex };
+	std::lock_guard<std::mutex> timersLock{ m_TimersMutex };
+
+	for (auto it{ std::begin(m_Threads) }; it != std::end(m_Threads);)
+	{
+		ThreadEvents& threadEvents{ **it };
+
+		//read before draining, a retired thread writes nothing after it
+		const bool isRetired{ threadEvents.buffer.IsRetired() };
+		const size_t eventCount{ threadEvents.buffer.Drain([this, &threadEvents](const ProfileEvent& event) { OnEvent(threadEvents, event); }) };
+
+		//threads can end before the capture is written, their name is kept as soon as they show up
+		if (eventCount > 0 && m_Capture.state != CaptureState::Idle)
+			m_Capture.trace.threadNames[threadEvents.threadId] = GetThreadName(threadEvents);
+
+		if (isRetired)
+			it = m_Threads.erase(it);
+		else
+			++it;
+	}
+
+	//every thread has been drained once since the stop time was known
+	if (m_Capture.state == CaptureState::Finishing)
+		FinishCapture();
+	else if (m_Capture.state == CaptureState::Stopping)
+		m_Capture.state = CaptureState::Finishing;
+
+	for (SpikeRecorder::Spike& spike : m_SpikeRecorder.TakeSpikes())
+		WriteSpike(std::move(spike));
+}
+
+void SDBX::Profiler::OnEvent(ThreadEvents& threadEvents, const ProfileEvent& event)
 {
-	Timer timer{};
-	timer.hash = Timer::Hash(fileName, fncName);
+	if (event.type == ProfileEventType::Frame)
+	{
+		OnFrame(event);
+		return;
+	}
 
-	auto existingHandle = std::find(std::begin(m_Timers), std::end(m_Timers), timer);
+	if (event.type == ProfileEventType::Begin)
+	{
+		//an id that was never registered stays out of the call tree, its children hang from the closest registered parent
+		uint32_t parentNode{ CallTree::ROOT };
+		for (auto openIt{ threadEvents.openTimers.rbegin() }; openIt != threadEvents.openTimers.rend(); ++openIt)
+		{
+			if (openIt->callTreeNode != CallTree::NO_NODE)
+			{
+				parentNode = openIt->callTreeNode;
+				break;
+			}
+		}
+
+		auto timerIt{ m_Timers.find(event.scopeId) };
+		const uint32_t node{ timerIt != std::end(m_Timers) ? m_FrameCallTree.GetChild(parentNode, timerIt->second.pScope) : CallTree::NO_NODE };
+		threadEvents.openTimers.push_back(OpenTimer{ event.scopeId, event.timestamp, node });
+		return;
+	}
 
-	if (existingHandle != std::end(m_Timers))
+	//events of a thread are balanced, the end always closes the last open timer
+	const OpenTimer openTimer{ threadEvents.openTimers.back() };
+	threadEvents.openTimers.pop_back();
+
+	//only scopes that lie completely inside the capture, whatever order the threads are drained in
+	if (m_Capture.state != CaptureState::Idle && openTimer.timestamp >= m_Capture.trace.startTimestamp && event.timestamp <= m_Capture.endTimestamp)
 	{
-		existingHandle->startPoint = Clock::now();
+		m_Capture.trace.scopes.push_back(ChromeTrace::Scope{ openTimer.scopeId, threadEvents.threadId, openTimer.timestamp, event.timestamp });
 	}
-	else
+
+	//an unregistered id has no descriptor, the trace writer skips it as well
+	if (openTimer.callTreeNode != CallTree::NO_NODE)
+		m_FrameCallTree.AddCall(openTimer.callTreeNode, event.timestamp - openTimer.timestamp);
+
+	auto timerIt{ m_Timers.find(openTimer.scopeId) };
+	if (timerIt == std::end(m_Timers))
+		return;
+
+	Timer& timer{ timerIt->second };
+	m_SpikeRecorder.AddScope(ChromeTrace::Scope{ openTimer.scopeId, threadEvents.threadId, openTimer.timestamp, event.timestamp }, timer.pScope);
+
+	timer.histogram.Record(event.timestamp - openTimer.timestamp);
+	if (timer.histogram.GetCount() == timer.pScope->frameCount)
 	{
-		timer.fileName = fileName;
-		timer.fncName = fncName;
-		timer.frameCount = frameCount;
-		timer.frame = 0;
-		timer.rate = 1.0 / frameCount;
-		timer.time = 0.0;
-		m_Timers.push_back(timer);
-		m_Timers.back().startPoint = Clock::now();
+		const LatencyStatistics statistics{ timer.histogram.GetStatistics(GetMicrosecondsPerTick() / 1000.0) };
+		SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::INFO_LOG, "Profiling Timer: " + std::string(timer.pScope->fileName) + "(" + std::to_string(timer.pScope->line) + ") : " + timer.pScope->fncName
+			+ " =====> mean " + std::to_string(statistics.mean) + "ms, min " + std::to_string(statistics.min) + "ms, p50 " + std::to_string(statistics.p50) + "ms, p95 " + std::to_string(statistics.p95)
+			+ "ms, p99 " + std::to_string(statistics.p99) + "ms, p99.9 " + std::to_string(statistics.p999) + "ms, max " + std::to_string(statistics.max) + "ms over " + std::to_string(statistics.count) + " calls");
+		timer.histogram.Reset();
 	}
+}
+
+void SDBX::Profiler::OnFrame(const ProfileEvent& event)
+{
+	//the frame this event closes is part of the capture
+	const bool isCapturedFrame{ m_Capture.state != CaptureState::Idle && m_Capture.state != CaptureState::Pending && event.timestamp <= m_Capture.endTimestamp };
+	OnCaptureFrame(event);
+
+	m_SpikeRecorder.AddFrame(event.scopeId, event.timestamp);
 
-	return timer.hash;
+	m_FrameCallTree.AddFrames(1);
+	if (isCapturedFrame)
+		m_Capture.callTree.Merge(m_FrameCallTree);
+
+	m_LastFrameCallTree = m_FrameCallTree;
+	m_FrameCallTree.ResetValues();
 }
 
-SDBX::Profiler::TimerHandle SDBX::Profiler::StartScopedTimer(const std::string& fileName, const std::string& fncName, uint32_t frameCount)
+void SDBX::Profiler::OnCaptureFrame(const ProfileEvent& event)
 {
-	return TimerHandle{ StartTimer(fileName, fncName, frameCount) };
+	if (m_Capture.state == CaptureState::Pending)
+	{
+		m_Capture.state = CaptureState::Running;
+		m_Capture.trace.startTimestamp = event.timestamp;
+	}
+	else if (m_Capture.state == CaptureState::Idle || event.timestamp > m_Capture.endTimestamp)
+	{
+		return;
+	}
+
+	m_Capture.trace.frames.push_back(ChromeTrace::Frame{ event.scopeId, event.timestamp });
+
+	//the frame that closes the last captured one ends the capture
+	if (m_Capture.state == CaptureState::Running && m_Capture.frameCount > 0 && m_Capture.capturedFrameCount++ == m_Capture.frameCount)
+	{
+		m_Capture.endTimestamp = event.timestamp;
+		m_Capture.state = CaptureState::Stopping;
+	}
 }
 
-void SDBX::Profiler::StopTimer(size_t hash)
+void SDBX::Profiler::FinishCapture()
 {
-	TimePoint endPoint{ Clock::now() };
+	//scopes drained before the first or the last frame was seen are only trimmed now
+	const int64_t startTimestamp{ m_Capture.trace.startTimestamp };
+	const int64_t endTimestamp{ m_Capture.endTimestamp };
+	auto& scopes{ m_Capture.trace.scopes };
+	scopes.erase(std::remove_if(std::begin(scopes), std::end(scopes), [startTimestamp, endTimestamp](const ChromeTrace::Scope& scope)
+	{
+		return scope.beginTimestamp < startTimestamp || scope.endTimestamp > endTimestamp;
+	}), std::end(scopes));
 
-	auto existingHandle = std::find_if(std::begin(m_Timers), std::end(m_Timers), [hash](const Timer& t) { return t.hash == hash; });
+	for (const ChromeTrace::Scope& scope : m_Capture.trace.scopes)
+	{
+		auto timerIt{ m_Timers.find(scope.scopeId) };
+		if (timerIt != std::end(m_Timers))
+			m_Capture.trace.descriptors.try_emplace(scope.scopeId, timerIt->second.pScope);
+	}
 
-	if (existingHandle != std::end(m_Timers))
+	m_LastCaptureCallTree = m_Capture.callTree;
+
+	QueueWrite([filePath = std::move(m_Capture.filePath), trace = std::move(m_Capture.trace), callTree = std::move(m_Capture.callTree)]()
 	{
-		double duration{ std::chrono::duration<double, std::ratio<1, 1000>>(endPoint - existingHandle->startPoint).count() };
-		existingHandle->time += duration * existingHandle->rate;
-		++existingHandle->frame;
-		if (existingHandle->frame == existingHandle->frameCount)
+		std::ofstream file{ filePath };
+		std::ofstream callTreeText{ filePath + ".calltree.txt" };
+		std::ofstream callTreeJson{ filePath + ".calltree.json" };
+		if (!file || !callTreeText || !callTreeJson)
 		{
-			SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::INFO_LOG, "Profiling Timer: " + existingHandle->fileName + " : " + existingHandle->fncName + " =====> " + std::to_string(duration) + "ms");
-			existingHandle->time = 0.0;
-			existingHandle->frame = 0;
+			SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::WARNING_LOG, "Profiling Capture: could not open " + filePath);
+			return;
 		}
+
+		WriteChromeTrace(file, trace);
+		callTree.WriteText(callTreeText);
+		callTree.WriteJson(callTreeJson);
+		SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::INFO_LOG, "Profiling Capture: written to " + filePath);
+	});
+
+	m_Capture = Capture{ CaptureState::Idle, std::string{}, 0, 0, INT64_MAX, ChromeTrace{}, CallTree{} };
+	m_IsCapturing.store(false, std::memory_order_relaxed);
+}
+
+void SDBX::Profiler::WriteSpike(SpikeRecorder::Spike&& spike)
+{
+	//threads that ended before the spike is written show up under their id
+	for (const std::unique_ptr<ThreadEvents>& pThreadEvents : m_Threads)
+		spike.trace.threadNames[pThreadEvents->threadId] = GetThreadName(*pThreadEvents);
+
+	const std::string filePath{ spike.filePrefix + "_frame" + std::to_string(spike.frameIndex) };
+	SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::WARNING_LOG, "Profiling Spike: frame " + std::to_string(spike.frameIndex) + " took " + std::to_string(spike.durationMilliseconds)
+		+ "ms (budget " + std::to_string(spike.budgetMilliseconds) + "ms), written to " + filePath + ".json");
+
+	QueueWrite([filePath, spike = std::move(spike)]()
+	{
+		std::ofstream file{ filePath + ".json" };
+		std::ofstream summary{ filePath + ".txt" };
+		if (!file || !summary)
+		{
+			SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::WARNING_LOG, "Profiling Spike: could not open " + filePath);
+			return;
+		}
+
+		WriteChromeTrace(file, spike.trace);
+
+		summary.setf(std::ios::fixed, std::ios::floatfield);
+		summary.precision(3);
+		summary << "Frame " << spike.frameIndex << " took " << spike.durationMilliseconds << "ms, budget " << spike.budgetMilliseconds << "ms\n\n";
+		spike.callTree.WriteTopScopes(summary, SPIKE_TOP_SCOPE_COUNT);
+		summary << "\n";
+		spike.callTree.WriteText(summary);
+	});
+}
+
+void SDBX::Profiler::QueueWrite(std::function<void()>&& write)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_WriteMutex };
+		m_WriteQueue.push_back(std::move(write));
 	}
-}
\ No newline at end of file
+	m_WriteCondition.notify_one();
+}
+
+void SDBX::Profiler::WriterLoop()
+{
+	std::unique_lock<std::mutex> lock{ m_WriteMutex };
+	while (true)
+	{
+		m_WriteCondition.wait(lock, [this]() { return m_IsWriterStopping || !m_WriteQueue.empty(); });
+		if (m_WriteQueue.empty())
+			return;
+
+		std::function<void()> write{ std::move(m_WriteQueue.front()) };
+		m_WriteQueue.pop_front();
+
+		//new writes can be queued while the file is written
+		lock.unlock();
+		write();
+		lock.lock();
+	}
+}
+
+#if SDBX_MEMORY_STATS_ENABLED
+void SDBX::Profiler::LogMemoryStats() const
+{
+	const Memory::MemorySnapshot snapshot{ Memory::MemoryStats::GetInstance().TakeSnapshot() };
+
+	for (Memory::MemoryTag tag{}; tag != Memory::MemoryTag::Count; tag = Memory::MemoryTag(size_t(tag) + 1))
+	{
+		const Memory::TagSnapshot& tagSnapshot{ snapshot.tags[size_t(tag)] };
+		SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::INFO_LOG, "Memory Tag: " + std::string(Memory::GetMemoryTagName(tag))
+			+ " =====> " + std::to_string(tagSnapshot.currentBytes) + "B (peak " + std::to_string(tagSnapshot.peakBytes) + "B), " + std::to_string(tagSnapshot.liveAllocations) + " allocations");
+	}
+
+	for (const Memory::AllocatorSnapshot& allocator : snapshot.allocators)
+	{
+		SDBX::Logger::Log<std::string>(SDBX::Logger::LogLevel::INFO_LOG, "Memory Allocator: " + std::string(allocator.name) + " : " + Memory::GetMemoryTagName(allocator.tag)
+			+ " =====> " + std::to_string(allocator.currentBytes) + "/" + std::to_string(allocator.capacity) + "B (peak " + std::to_string(allocator.peakBytes) + "B), "
+			+ std::to_string(allocator.liveAllocations) + " allocations, largest free " + std::to_string(allocator.largestFreeBlock) + "B, fragmentation " + std::to_string(allocator.fragmentation));
+	}
+}
+#endif
@@ -1,76 +1,262 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "Core\Base\Singleton.h"
 #include "Core\Log\Logger.h"
+#include "Core\Memory\MemoryStats.h"
+#include "Core\Profiling\CallTree.h"
+#include "Core\Profiling\ChromeTrace.h"
+#include "Core\Profiling\LatencyHistogram.h"
+#include "Core\Profiling\ProfileClock.h"
+#include "Core\Profiling\ProfileEventBuffer.h"
+#include "Core\Profiling\ProfileScope.h"
+#include "Core\Profiling\SpikeRecorder.h"
 
+//Timers only write begin/end events in a lock-free buffer owned by the calling thread, so they can be used from any thread.
+//A collector thread drains the buffers every COLLECT_PERIOD and does the aggregation and logging.
+//Each scope fills a latency histogram, its min, mean, percentiles and max are logged every frameCount calls.
+//Timestamps come from ProfileClock, the invariant TSC when the CPU has one.
+//With spike capture enabled the collector also keeps the last frames in a SpikeRecorder and writes the frames over budget as they happen.
+//Every macro site owns a static ProfileScope registered on first use, the recording path only passes its compile time id.
+//Captures record every scope of every thread between two points in time and write them as a Chrome trace from a background thread.
+//Files are queued to a long lived writer thread, the collector never waits on the disk while it holds its locks.
+//Scopes are also aggregated in a call tree per frame, a capture writes the call tree of its frames next to the trace.
 namespace SDBX
 {
-	using TimePoint = std::chrono::high_resolution_clock::time_point;
-	using Clock = std::chrono::high_resolution_clock;
-
 	class Profiler final : public Singleton<Profiler>
 	{
 	public:
 		struct TimerHandle
 		{
-			size_t hash;
+			bool isActive;
 
-			explicit TimerHandle(size_t hash) : hash{ hash } {};
+			explicit TimerHandle(bool isActive) : isActive{ isActive } {};
 			TimerHandle(const TimerHandle& other) = delete;
-			TimerHandle(TimerHandle&& other) noexcept : hash{ other.hash } { other.hash = 0; }
+			TimerHandle(TimerHandle&& other) noexcept : isActive{ other.isActive } { other.isActive = false; }
 			TimerHandle& operator=(const TimerHandle& other) = delete;
-			TimerHandle& operator=(TimerHandle&& other) noexcept { hash = other.hash; other.hash = 0; return *this; }
+			TimerHandle& operator=(TimerHandle&& other) noexcept = delete;
 
-			bool operator==(const TimerHandle& other) const { return hash == other.hash; }
-			bool operator!=(const TimerHandle& other) const { return !(*this == other); }
+			~TimerHandle() { if (isActive) SDBX::Profiler::GetInstance().StopTimer(); }
+		};
 
-			~TimerHandle() { SDBX::Profiler::GetInstance().StopTimer(hash); }
+		// Registers a scope when the static owning it is initialized
+		struct ScopeRegistration
+		{
+			explicit ScopeRegistration(const ProfileScope& scope) { SDBX::Profiler::GetInstance().RegisterScope(scope); }
 		};
 
-		~Profiler() override = default;
+		static constexpr std::chrono::milliseconds COLLECT_PERIOD{ 5 };
+		// Scopes listed at the top of a spike summary
+		static constexpr uint32_t SPIKE_TOP_SCOPE_COUNT{ 10 };
+
+		~Profiler() override;
 		Profiler(const Profiler& other) = delete;
 		Profiler(Profiler&& other) noexcept = delete;
 		Profiler& operator=(const Profiler& other) = delete;
 		Profiler& operator=(Profiler&& other) noexcept = delete;
 
-		TimerHandle StartScopedTimer(const std::string& fileName, const std::string& fncName, uint32_t frameCount = 1);
-		size_t StartTimer(const std::string& fileName, const std::string& fncName, uint32_t frameCount = 1);
-		void StopTimer(size_t hash);
+		// The scope must outlive the profiler, it is meant to be a static at the macro site
+		void RegisterScope(const ProfileScope& scope);
+
+		inline TimerHandle StartScopedTimer(uint64_t scopeId) { StartTimer(scopeId); return TimerHandle{ true }; }
+		inline void StartTimer(uint64_t scopeId);
+		// Closes the last timer started on the calling thread
+		inline void StopTimer();
+
+		// Aggregate every event recorded so far without waiting for the collector
+		void Flush();
+
+		// Call once per frame from the main loop, frames delimit captures and show up in the trace
+		inline void MarkFrame();
+
+		// Name the calling thread in captures
+		void SetThreadName(const std::string& name);
+
+		// Capture from now until StopCapture, the trace is written to filePath in the background, the call tree of the captured frames to filePath.calltree.txt/.json
+		void StartCapture(const std::string& filePath);
+		// Capture frameCount whole frames starting at the next MarkFrame
+		void CaptureFrames(const std::string& filePath, uint32_t frameCount);
+		void StopCapture();
+		bool IsCapturing() const { return m_IsCapturing.load(std::memory_order_relaxed); }
+
+		// Keep the last frames of events and write every frame over budget with its neighbours, as a trace and a summary of its top scopes
+		void EnableSpikeCapture(const SpikeRecorder::Settings& settings);
+		void DisableSpikeCapture();
+
+		ProfileClockSource GetClockSource() const { return m_ClockSource; }
+
+		// Call tree of the last frame the collector closed, scopes are accounted to the frame in which the collector reads their end
+		CallTree GetLastFrameCallTree();
+		// Call tree of the whole frames of the last finished capture, per frame averages. Keep one to diff it with a later capture (CallTree::WriteDiff)
+		CallTree GetLastCaptureCallTree();
+
+#if SDBX_MEMORY_STATS_ENABLED
+		// Log the per tag totals and the state of every tracked allocator
+		void LogMemoryStats() const;
+#endif
 	private:
 		friend class Singleton<Profiler>;
-		explicit Profiler() = default;
+		explicit Profiler();
 
 		struct Timer
 		{
-			TimePoint startPoint;
-			double rate;
-			size_t hash;
-			std::string fileName;
-			std::string fncName;
+			const ProfileScope* pScope;
+			LatencyHistogram histogram;
+		};
+
+		struct OpenTimer
+		{
+			uint64_t scopeId;
+			int64_t timestamp;
+			uint32_t callTreeNode;
+		};
+
+		//the buffer is written by its thread, the rest is only touched with m_ThreadsMutex held
+		struct ThreadEvents
+		{
+			ProfileEventBuffer buffer;
+			std::vector<OpenTimer> openTimers;
+			uint32_t threadId;
+			std::string name;
+		};
+
+		enum class CaptureState
+		{
+			Idle
+			// Waiting for the next frame
+			, Pending
+			, Running
+			// Last frame seen, other threads get one more collect pass to hand in their scopes
+			, Stopping
+			// Stop time reached, written once the current collect pass is done
+			, Finishing
+		};
+
+		struct Capture
+		{
+			CaptureState state;
+			std::string filePath;
+			// 0 until StopCapture
 			uint32_t frameCount;
-			uint32_t frame;
-			double time;
+			uint32_t capturedFrameCount;
+			int64_t endTimestamp;
+			ChromeTrace trace;
+			CallTree callTree;
+		};
 
-			bool operator==(const Timer& other) const { return hash == other.hash; }
-			bool operator!=(const Timer& other) const { return !(*this == other); }
+		//marks the events of a finished thread so the collector frees them once drained
+		struct ThreadEventsHolder
+		{
+			~ThreadEventsHolder();
 
-			inline static size_t Hash(const std::string& fileName, const std::string& fncName) { return std::hash<std::string>()(fileName + ":" + fncName); };
+			ThreadEvents* pThreadEvents;
 		};
 
-		std::vector<Timer> m_Timers;
+		inline static int64_t GetTimestamp() { return ProfileClock::Now(); }
+		inline static double GetMicrosecondsPerTick() { return ProfileClock::GetMicrosecondsPerTick(); }
+
+		static std::string GetThreadName(const ThreadEvents& threadEvents) { return threadEvents.name.empty() ? "Thread " + std::to_string(threadEvents.threadId) : threadEvents.name; }
+
+		inline ThreadEvents& GetThreadEvents() { return s_ThreadEvents.pThreadEvents ? *s_ThreadEvents.pThreadEvents : AddThreadEvents(); }
+		ThreadEvents& AddThreadEvents();
+
+		void CollectorLoop();
+		//m_CollectMutex must be held
+		void Collect();
+		void OnEvent(ThreadEvents& threadEvents, const ProfileEvent& event);
+		void OnFrame(const ProfileEvent& event);
+		void OnCaptureFrame(const ProfileEvent& event);
+		//m_CollectMutex, m_ThreadsMutex and m_TimersMutex must be held
+		void FinishCapture();
+		//writes run in order on the writer thread
+		void QueueWrite(std::function<void()>&& write);
+		void WriterLoop();
+		//m_CollectMutex and m_ThreadsMutex must be held
+		void WriteSpike(SpikeRecorder::Spike&& spike);
+
+		static thread_local ThreadEventsHolder s_ThreadEvents;
+
+		//first member, the clock is set up before any other member reads it
+		ProfileClockSource m_ClockSource;
+
+		std::mutex m_ThreadsMutex;
+		std::vector<std::unique_ptr<ThreadEvents>> m_Threads;
+		uint32_t m_NextThreadId;
+
+		//scopes are registered by the recording threads, read by the collector
+		std::mutex m_TimersMutex;
+		std::unordered_map<uint64_t, Timer> m_Timers;
+
+		std::mutex m_CollectMutex;
+		std::condition_variable m_CollectCondition;
+		bool m_IsStopping;
+		std::thread m_CollectorThread;
+
+		std::atomic<uint64_t> m_FrameIndex;
+		//owned by the collector, m_CollectMutex must be held
+		CallTree m_FrameCallTree;
+		CallTree m_LastFrameCallTree;
+		CallTree m_LastCaptureCallTree;
+		Capture m_Capture;
+		SpikeRecorder m_SpikeRecorder;
+		std::atomic<bool> m_IsCapturing;
+
+		std::mutex m_WriteMutex;
+		std::condition_variable m_WriteCondition;
+		std::deque<std::function<void()>> m_WriteQueue;
+		bool m_IsWriterStopping;
+		std::thread m_WriterThread;
 	};
 }
 
+void SDBX::Profiler::StartTimer(uint64_t scopeId)
+{
+	GetThreadEvents().buffer.PushBegin(GetTimestamp(), scopeId);
+}
+
+void SDBX::Profiler::StopTimer()
+{
+	const int64_t endTimestamp{ GetTimestamp() };
+	GetThreadEvents().buffer.PushEnd(endTimestamp);
+}
+
+void SDBX::Profiler::MarkFrame()
+{
+	GetThreadEvents().buffer.PushFrame(GetTimestamp(), m_FrameIndex.fetch_add(1, std::memory_order_relaxed));
+}
+
 #if defined(SDBX_PROFILING) || defined(_DEBUG) || defined(DEBUG)
-	#define BEGIN_TIMER_PROFILLING_N(frameCount) size_t hash_##__FUNCTION__ = SDBX::Profiler::GetInstance().StartTimer(STR1(__FILE__), __func__, frameCount);
-	#define BEGIN_TIMER_PROFILLING() BEGIN_TIMER_PROFILLING_N(1) 
-	#define END_TIMER_PROFILLING() SDBX::Profiler::GetInstance().StopTimer(hash_##__FUNCTION__);
+	#define SDBX_PROFILING_CONCAT_IMP(a, b) a##b
+	#define SDBX_PROFILING_CONCAT(a, b) SDBX_PROFILING_CONCAT_IMP(a, b)
+
+	//the variables are suffixed with a counter so any number of scopes can live in one function, scopes written on the same line share their id
+	#define SDBX_PROFILING_SCOPE(frameCount, counter) \
+		static constexpr uint64_t SDBX_PROFILING_CONCAT(profileScopeId_, counter){ SDBX::HashProfileScope(__FILE__, __LINE__) }; \
+		static const SDBX::ProfileScope SDBX_PROFILING_CONCAT(profileScope_, counter){ SDBX_PROFILING_CONCAT(profileScopeId_, counter), __FILE__, __func__, __LINE__, frameCount }; \
+		static const SDBX::Profiler::ScopeRegistration SDBX_PROFILING_CONCAT(profileScopeRegistration_, counter){ SDBX_PROFILING_CONCAT(profileScope_, counter) };
 
-	#define SCOPED_TIMER_PROFILLING_N(frameCount) SDBX::Profiler::TimerHandle handle_##__FUNCTION__ = SDBX::Profiler::GetInstance().StartScopedTimer(STR1(__FILE__), __func__, frameCount);
-	#define SCOPED_TIMER_PROFILLING() SCOPED_TIMER_PROFILLING_N(1) 
+	#define SDBX_BEGIN_TIMER_PROFILLING_IMP(frameCount, counter) { SDBX_PROFILING_SCOPE(frameCount, counter) SDBX::Profiler::GetInstance().StartTimer(SDBX_PROFILING_CONCAT(profileScopeId_, counter)); }
+	#define SDBX_SCOPED_TIMER_PROFILLING_IMP(frameCount, counter) SDBX_PROFILING_SCOPE(frameCount, counter) \
+		SDBX::Profiler::TimerHandle SDBX_PROFILING_CONCAT(timerHandle_, counter){ SDBX::Profiler::GetInstance().StartScopedTimer(SDBX_PROFILING_CONCAT(profileScopeId_, counter)) };
+
+	#define BEGIN_TIMER_PROFILLING_N(frameCount) SDBX_BEGIN_TIMER_PROFILLING_IMP(frameCount, __COUNTER__)
+	#define BEGIN_TIMER_PROFILLING() BEGIN_TIMER_PROFILLING_N(1)
+	#define END_TIMER_PROFILLING() SDBX::Profiler::GetInstance().StopTimer();
+
+	#define SCOPED_TIMER_PROFILLING_N(frameCount) SDBX_SCOPED_TIMER_PROFILLING_IMP(frameCount, __COUNTER__)
+	#define SCOPED_TIMER_PROFILLING() SCOPED_TIMER_PROFILLING_N(1)
+
+	#define MARK_FRAME_PROFILLING() SDBX::Profiler::GetInstance().MarkFrame();
 #else
 	#define BEGIN_TIMER_PROFILLING_N(frameCount)
 	#define BEGIN_TIMER_PROFILLING()
@@ -78,4 +264,12 @@ namespace SDBX
 
 	#define SCOPED_TIMER_PROFILLING_N(frameCount)
 	#define SCOPED_TIMER_PROFILLING()
+
+	#define MARK_FRAME_PROFILLING()
+#endif
+
+#if SDBX_MEMORY_STATS_ENABLED
+	#define LOG_MEMORY_STATS_PROFILLING_N(frameCount) { static uint32_t memoryStatsFrame{}; if (++memoryStatsFrame % (frameCount) == 0) SDBX::Profiler::GetInstance().LogMemoryStats(); }
+#else
+	#define LOG_MEMORY_STATS_PROFILLING_N(frameCount)
 #endif
\ No newline at end of file
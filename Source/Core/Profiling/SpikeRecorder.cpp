@@ -0,0 +1,192 @@
+#include "SpikeRecorder.h"
+
+#include <algorithm>
+
+#include "Core/Log/Logger.h"
+
+SDBX::SpikeRecorder::SpikeRecorder()
+	: m_Settings()
+	, m_IsEnabled(false)
+	, m_MicrosecondsPerTick(0.0)
+	, m_BudgetTicks(0)
+	, m_Frames()
+	, m_NewestFrame(0)
+	, m_FrameCount(0)
+	, m_IsSpikePending(false)
+	, m_FramesUntilSpikeReady(0)
+	, m_ReadySpikeFrames()
+{}
+
+void SDBX::SpikeRecorder::Enable(const Settings& settings, double microsecondsPerTick)
+{
+	SDBX_ASSERT_MSG(settings.frameBudgetMilliseconds > 0.0, "The spike frame budget must be positive")
+	SDBX_ASSERT_MSG(settings.historyFrameCount >= 2 * settings.neighbourFrameCount + 1, "The spike history must hold a spike and its neighbours")
+
+	m_Settings = settings;
+	m_IsEnabled = true;
+	m_MicrosecondsPerTick = microsecondsPerTick;
+	m_BudgetTicks = int64_t(settings.frameBudgetMilliseconds * 1000.0 / microsecondsPerTick);
+
+	//one more for the open frame
+	m_Frames.resize(size_t(settings.historyFrameCount) + 1);
+	m_NewestFrame = 0;
+	m_FrameCount = 0;
+	m_IsSpikePending = false;
+	m_FramesUntilSpikeReady = 0;
+}
+
+void SDBX::SpikeRecorder::Disable()
+{
+	m_IsEnabled = false;
+	m_Frames.clear();
+	m_Frames.shrink_to_fit();
+	m_FrameCount = 0;
+	m_IsSpikePending = false;
+	m_ReadySpikeFrames.clear();
+}
+
+void SDBX::SpikeRecorder::AddScope(const ChromeTrace::Scope& scope, const ProfileScope* pScope)
+{
+	if (!m_IsEnabled)
+		return;
+
+	//scopes of other threads can be read after a later frame mark, look back for the frame they began in
+	for (uint32_t ageIdx{}; ageIdx < m_FrameCount; ++ageIdx)
+	{
+		Frame& frame{ m_Frames[GetFrameSlot(ageIdx)] };
+		if (frame.beginTimestamp <= scope.beginTimestamp)
+		{
+			frame.scopes.push_back(RecordedScope{ scope, pScope });
+			return;
+		}
+	}
+}
+
+void SDBX::SpikeRecorder::AddFrame(uint64_t frameIndex, int64_t timestamp)
+{
+	if (!m_IsEnabled)
+		return;
+
+	if (m_FrameCount > 0)
+	{
+		Frame& closedFrame{ m_Frames[m_NewestFrame] };
+		closedFrame.endTimestamp = timestamp;
+
+		if (m_IsSpikePending)
+		{
+			--m_FramesUntilSpikeReady;
+		}
+		else if (timestamp - closedFrame.beginTimestamp > m_BudgetTicks)
+		{
+			m_IsSpikePending = true;
+			m_FramesUntilSpikeReady = m_Settings.neighbourFrameCount;
+		}
+
+		//the neighbours after the spike are closed, the spike is neighbourFrameCount frames old
+		if (m_IsSpikePending && m_FramesUntilSpikeReady == 0)
+		{
+			m_ReadySpikeFrames.push_back(m_Frames[GetFrameSlot(m_Settings.neighbourFrameCount)].frameIndex);
+			m_IsSpikePending = false;
+		}
+	}
+
+	//the oldest frame is recycled, its scopes keep their capacity
+	m_NewestFrame = uint32_t((m_NewestFrame + 1) % m_Frames.size());
+	m_FrameCount = std::min(m_FrameCount + 1, uint32_t(m_Frames.size()));
+
+	Frame& openFrame{ m_Frames[m_NewestFrame] };
+	openFrame.frameIndex = frameIndex;
+	openFrame.beginTimestamp = timestamp;
+	openFrame.endTimestamp = INT64_MAX;
+	openFrame.scopes.clear();
+}
+
+std::vector<SDBX::SpikeRecorder::Spike> SDBX::SpikeRecorder::TakeSpikes()
+{
+	std::vector<Spike> spikes{};
+	for (const uint64_t spikeFrameIndex : m_ReadySpikeFrames)
+	{
+		//later frames can have been marked in the same collect, the closed neighbours of the spike keep it at least one frame old
+		for (uint32_t ageIdx{ 1 + m_Settings.neighbourFrameCount }; ageIdx < m_FrameCount; ++ageIdx)
+		{
+			if (m_Frames[GetFrameSlot(ageIdx)].frameIndex == spikeFrameIndex)
+			{
+				spikes.push_back(MakeSpike(ageIdx));
+				break;
+			}
+		}
+	}
+
+	m_ReadySpikeFrames.clear();
+	return spikes;
+}
+
+SDBX::SpikeRecorder::Spike SDBX::SpikeRecorder::MakeSpike(uint32_t spikeAgeIdx) const
+{
+	const Frame& spikeFrame{ m_Frames[GetFrameSlot(spikeAgeIdx)] };
+	Spike spike{ m_Settings.filePrefix, spikeFrame.frameIndex, double(spikeFrame.endTimestamp - spikeFrame.beginTimestamp) * m_MicrosecondsPerTick / 1000.0
+		, m_Settings.frameBudgetMilliseconds, ChromeTrace{}, CallTree{ m_MicrosecondsPerTick / 1000.0 } };
+
+	//the history can be shorter than the window after a spike early on
+	const uint32_t oldestAgeIdx{ std::min(spikeAgeIdx + m_Settings.neighbourFrameCount, m_FrameCount - 1) };
+	spike.trace.startTimestamp = m_Frames[GetFrameSlot(oldestAgeIdx)].beginTimestamp;
+	spike.trace.microsecondsPerTick = m_MicrosecondsPerTick;
+
+	for (uint32_t ageIdx{ oldestAgeIdx + 1 }; ageIdx-- > spikeAgeIdx - m_Settings.neighbourFrameCount;)
+	{
+		const Frame& frame{ m_Frames[GetFrameSlot(ageIdx)] };
+		spike.trace.frames.push_back(ChromeTrace::Frame{ frame.frameIndex, frame.beginTimestamp });
+
+		for (const RecordedScope& recordedScope : frame.scopes)
+		{
+			spike.trace.scopes.push_back(recordedScope.scope);
+			spike.trace.descriptors.try_emplace(recordedScope.scope.scopeId, recordedScope.pScope);
+		}
+	}
+
+	//end of the last frame of the window
+	const Frame& newestFrame{ m_Frames[GetFrameSlot(spikeAgeIdx - m_Settings.neighbourFrameCount)] };
+	spike.trace.frames.push_back(ChromeTrace::Frame{ newestFrame.frameIndex + 1, newestFrame.endTimestamp });
+
+	AddToCallTree(spike.callTree, spikeFrame.scopes);
+	spike.callTree.AddFrames(1);
+	return spike;
+}
+
+void SDBX::SpikeRecorder::AddToCallTree(CallTree& callTree, std::vector<RecordedScope> scopes)
+{
+	struct OpenScope
+	{
+		int64_t endTimestamp;
+		uint32_t node;
+	};
+
+	//a parent begins first, or at the same time and ends last
+	std::sort(std::begin(scopes), std::end(scopes), [](const RecordedScope& lhs, const RecordedScope& rhs)
+	{
+		if (lhs.scope.threadId != rhs.scope.threadId)
+			return lhs.scope.threadId < rhs.scope.threadId;
+		if (lhs.scope.beginTimestamp != rhs.scope.beginTimestamp)
+			return lhs.scope.beginTimestamp < rhs.scope.beginTimestamp;
+		return lhs.scope.endTimestamp > rhs.scope.endTimestamp;
+	});
+
+	std::vector<OpenScope> openScopes{};
+	uint32_t threadId{};
+	for (const RecordedScope& recordedScope : scopes)
+	{
+		if (recordedScope.scope.threadId != threadId)
+		{
+			openScopes.clear();
+			threadId = recordedScope.scope.threadId;
+		}
+
+		while (!openScopes.empty() && openScopes.back().endTimestamp < recordedScope.scope.endTimestamp)
+			openScopes.pop_back();
+
+		//scopes whose parent began before the frame become roots
+		const uint32_t node{ callTree.GetChild(openScopes.empty() ? CallTree::ROOT : openScopes.back().node, recordedScope.pScope) };
+		callTree.AddCall(node, recordedScope.scope.endTimestamp - recordedScope.scope.beginTimestamp);
+		openScopes.push_back(OpenScope{ recordedScope.scope.endTimestamp, node });
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Core/Profiling/CallTree.h"
+#include "Core/Profiling/ChromeTrace.h"
+#include "Core/Profiling/ProfileScope.h"
+
+//Always on flight recorder of the last frames, fed by the profiler collector with every finished scope and frame mark.
+//When a frame goes over its budget, the frame and neighbourFrameCount frames on each side are turned into a ChromeTrace,
+//along with the call tree of the slow frame. Frames inside a window already taken don't start another one.
+//Scopes are filed in the frame they begin in, frames are kept in a ring so the recorder stops allocating once warm.
+//AddFrame only marks a spike ready, it is built by TakeSpikes once the collector drained every thread: the scopes other threads
+//recorded in the last frames of the window are only read after the frame mark.
+namespace SDBX
+{
+	class SpikeRecorder final
+	{
+	public:
+		struct Settings
+		{
+			// Spikes are written to filePrefix_frame<index>.json, their summary to filePrefix_frame<index>.txt
+			std::string filePrefix;
+			double frameBudgetMilliseconds;
+			// Frames kept, at least 2 * neighbourFrameCount + 1
+			uint32_t historyFrameCount;
+			uint32_t neighbourFrameCount;
+		};
+
+		struct Spike
+		{
+			std::string filePrefix;
+			uint64_t frameIndex;
+			double durationMilliseconds;
+			double budgetMilliseconds;
+			// Thread names are left to the caller
+			ChromeTrace trace;
+			CallTree callTree;
+		};
+
+		explicit SpikeRecorder();
+
+		void Enable(const Settings& settings, double microsecondsPerTick);
+		void Disable();
+		bool IsEnabled() const { return m_IsEnabled; }
+
+		// The scope descriptor must outlive the recorder
+		void AddScope(const ChromeTrace::Scope& scope, const ProfileScope* pScope);
+		void AddFrame(uint64_t frameIndex, int64_t timestamp);
+
+		// Spikes whose window is complete, call once every thread is drained.
+		// A spike whose frames left the history meanwhile (more than historyFrameCount frames in one collect) is dropped
+		std::vector<Spike> TakeSpikes();
+
+	private:
+		struct RecordedScope
+		{
+			ChromeTrace::Scope scope;
+			const ProfileScope* pScope;
+		};
+
+		struct Frame
+		{
+			uint64_t frameIndex;
+			int64_t beginTimestamp;
+			// INT64_MAX while the frame is open
+			int64_t endTimestamp;
+			std::vector<RecordedScope> scopes;
+		};
+
+		//ring index of the frame ageIdx frames before the newest one
+		uint32_t GetFrameSlot(uint32_t ageIdx) const { return uint32_t((m_NewestFrame + m_Frames.size() - ageIdx) % m_Frames.size()); }
+		//the window spans neighbourFrameCount frames on each side of the spike, the ones after it are closed
+		Spike MakeSpike(uint32_t spikeAgeIdx) const;
+		//nests the scopes of each thread on their timestamps
+		static void AddToCallTree(CallTree& callTree, std::vector<RecordedScope> scopes);
+
+		Settings m_Settings;
+		bool m_IsEnabled;
+		double m_MicrosecondsPerTick;
+		int64_t m_BudgetTicks;
+
+		//the newest frame is still open
+		std::vector<Frame> m_Frames;
+		uint32_t m_NewestFrame;
+		uint32_t m_FrameCount;
+
+		bool m_IsSpikePending;
+		uint32_t m_FramesUntilSpikeReady;
+		//frame index of the spikes whose window is closed
+		std::vector<uint64_t> m_ReadySpikeFrames;
+	};
+}
@@ -0,0 +1,39 @@
+#include "pch.h"
+#include "GameObject.h"
+
+#include <algorithm>
+
+#include "Gameplay/Components/IComponent.h"
+
+namespace
+{
+	struct ComponentAllocator
+	{
+		ComponentAllocator() : allocator{} { allocator.SetStatsInfo("ComponentAllocator", SDBX::Memory::MemoryTag::Gameplay); }
+
+		SDBX::Memory::SmallObjectAllocator allocator;
+	};
+}
+
+SDBX::GameObject::~GameObject()
+{
+	//reverse order so a component can still reach the ones added before it while it is destroyed
+	for (auto it{ std::rbegin(m_ComponentPtrs) }; it != std::rend(m_ComponentPtrs); ++it)
+		GetComponentAllocator().Release(*it);
+}
+
+void SDBX::GameObject::RemoveComponent(IComponent* pComponent)
+{
+	auto it{ std::find(std::begin(m_ComponentPtrs), std::end(m_ComponentPtrs), pComponent) };
+	SDBX_ASSERT_MSG(it != std::end(m_ComponentPtrs), "Component doesn't belong to this GameObject")
+
+	m_ComponentPtrs.erase(it);
+	GetComponentAllocator().Release(pComponent);
+}
+
+SDBX::Memory::SmallObjectAllocator& SDBX::GameObject::GetComponentAllocator()
+{
+	//shared by every GameObject so components of the same size end up next to each other whatever object they belong to
+	static ComponentAllocator componentAllocator{};
+	return componentAllocator.allocator;
+}
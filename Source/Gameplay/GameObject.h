@@ -1,7 +1,10 @@
 #pragma once
+#include <algorithm>
+#include <memory_resource>
 #include <vector>
 #include <string>
 
+#include "Core/Memory/Allocator/SmallObjectAllocator.h"
 #include "Gameplay/Components/Transform.h"
 
 namespace SDBX
@@ -14,10 +17,12 @@ namespace SDBX
 		//friend class Scene;
 	public:
 
-		using Components = std::vector<IComponent*>;
+		using Components = std::pmr::vector<IComponent*>;
 		
-		explicit GameObject(const Transform& transform = Transform(), const std::wstring& name = L"GameObject", const std::wstring& tag = L"")
-			: m_ComponentPtrs{ }, m_Transform{ transform }, m_Name{ name }, m_Tag{ tag }/*, m_pParentScene{}*/, m_IsEnabled{ true } {}
+		// pResource backs the component list
+		explicit GameObject(const Transform& transform = Transform(), const std::wstring& name = L"GameObject", const std::wstring& tag = L"", std::pmr::memory_resource* pResource = std::pmr::get_default_resource())
+			: m_ComponentPtrs{ pResource }, m_Transform{ transform }, m_Name{ name }, m_Tag{ tag }/*, m_pParentScene{}*/, m_IsEnabled{ true } {}
+		~GameObject();
 		GameObject(const GameObject& other) = delete;
 		GameObject(GameObject&& other) = delete;
 		GameObject& operator=(const GameObject& other) = delete;
@@ -26,6 +31,9 @@ namespace SDBX
 		template<typename ComponentType, typename... ARG_TYPE, typename = std::enable_if_t<std::is_base_of_v<IComponent, ComponentType>>>
 		ComponentType* AddComponent(ARG_TYPE&&... arguments);
 
+		// Destroys the component, it must belong to this GameObject
+		void RemoveComponent(IComponent* pComponent);
+
 		template<typename ComponentType, typename = std::enable_if_t<std::is_base_of_v<IComponent, ComponentType>>>
 		ComponentType* GetComponent() const;
 
@@ -50,6 +58,9 @@ namespace SDBX
 		bool IsEnabled() const { return m_IsEnabled; }
 
 		//void Delete() { m_pParentScene.lock()->Remove(shared_from_this()); }
+
+		// Components of every GameObject come from this allocator and are owned by their GameObject, it is not thread safe
+		static Memory::SmallObjectAllocator& GetComponentAllocator();
 	
 	private:
 		Components m_ComponentPtrs;
@@ -63,7 +74,7 @@ namespace SDBX
 	template<typename ComponentType, typename... ARG_TYPE, typename>
 	ComponentType* GameObject::AddComponent(ARG_TYPE&&... arguments)
 	{
-		ComponentType* newComp{ new ComponentType(std::forward<ARG_TYPE>(arguments)...) };
+		ComponentType* newComp{ GetComponentAllocator().Acquire<ComponentType>(std::forward<ARG_TYPE>(arguments)...) };
 		newComp->SetParentGo(this);
 		m_ComponentPtrs.push_back(newComp);
 		return newComp;
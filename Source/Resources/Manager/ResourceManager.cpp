@@ -7,9 +7,18 @@ SDBX::Resource::ResourceManager::~ResourceManager()
 		delete loaderPair.second;
 }
 
-void SDBX::Resource::ResourceManager::Init(const std::wstring& dataPath)
+void SDBX::Resource::ResourceManager::Init(const std::wstring& dataPath, std::pmr::memory_resource* pResource)
 {
 	m_DataPath = dataPath;
+
+	SDBX_ASSERT_MSG(m_pResource.empty(), "Resource memory can't be changed once resources are loaded")
+
+	//pmr containers keep their own resource on assignment, the map has to be rebuilt in place to switch it
+	if (m_pResource.get_allocator().resource() != pResource)
+	{
+		m_pResource.~ResourceMap();
+		new (&m_pResource) ResourceMap{ pResource };
+	}
 }
 
 void SDBX::Resource::ResourceManager::RegisterLoader(ILoader* resourceLoader)
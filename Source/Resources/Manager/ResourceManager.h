@@ -1,4 +1,5 @@
 #pragma once
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
 #include <iostream>
@@ -22,7 +23,8 @@ namespace SDBX
 			ResourceManager& operator=(const ResourceManager& other) = delete;
 			ResourceManager& operator=(ResourceManager&& other) = delete;
 
-			void Init(const std::wstring& data);
+			// pResource backs the resource map, it can only be changed before the first resource is loaded
+			void Init(const std::wstring& data, std::pmr::memory_resource* pResource = std::pmr::get_default_resource());
 			void RegisterLoader(ILoader* resourceLoader);
 
 			template<typename ResourceType, typename... ArgType>
@@ -34,7 +36,8 @@ namespace SDBX
 			std::wstring m_DataPath;
 			std::unordered_map<std::string, ILoader*> m_Loaders;
 
-			std::unordered_map<std::string, IResource*> m_pResource;
+			using ResourceMap = std::pmr::unordered_map<std::string, IResource*>;
+			ResourceMap m_pResource;
 		};
 
 		template<typename ResourceType, typename... ArgType>
@@ -10,6 +10,7 @@
 #include "Core\Maths\Mat.h"
 #include "Core\Maths\Vec.h"
 #include "Core\Log\Logger.h"
+#include "Core\Memory\Allocator\FrameAllocator.h"
 #include "Core\Profiling\Profiler.h"
 #include "Renderer/API/DX11/DX11Render.h"
 
@@ -102,6 +103,8 @@ int wmain(int, wchar_t* [])
     SDBX::DX11::DX11Render renderer;
     renderer.Init(wnd, viewports, vpCount);
 
+    SDBX::Memory::FrameAllocator::GetInstance().Init(SDBX::Memory::FrameAllocator::DEFAULT_THREAD_ARENA_SIZE);
+
     while (msg.message != WM_QUIT)
     {
         while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
@@ -113,6 +116,10 @@ int wmain(int, wchar_t* [])
         }
 
         renderer.Present();
+        SDBX::Memory::FrameAllocator::GetInstance().EndFrame();
+
+        MARK_FRAME_PROFILLING();
+        LOG_MEMORY_STATS_PROFILLING_N(600);
     }
 }
 